@@ -0,0 +1,473 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+/*
+ * Stage-level encoder benchmark. The stages are static functions, so
+ * the encoder is compiled right into this file.
+ */
+#include "aztec_encode.c"
+
+#include "test_alloc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RET_OK 0
+#define RET_ERR 1
+#define RET_CMDLINE 2
+
+#define BENCH_SHORT (24)
+#define BENCH_LONG (320)
+
+/* Deterministic payloads */
+
+typedef struct bench_corpus {
+    const char* name;
+    const char* pattern;    /* NULL for generated data */
+    guint alphabet;         /* Size of the generated alphabet */
+} BenchCorpus;
+
+static const BenchCorpus bench_corpora[] = {
+    { "upper", "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG ", 0 },
+    { "lower", "the quick brown fox jumps over the lazy dog ", 0 },
+    { "punct", "Hi, there! Is it 3:45? (Yes); 'ok' [x=y+z] ... ", 0 },
+    { "digits", NULL, 10 },
+    { "url", "https://example.com/track?id=0042137&ref=mail&lang=en/", 0 },
+    { "bcbp", "M1DESMARAIS/LUC       EABC123 YULFRAAC 0834 326J001A0025 "
+      "100", 0 },
+    { "binary", NULL, 256 },
+    /* Every character wants a different mode */
+    { "alternate", "a1B.\x01\xe9" "A:b2\x7f,\x80z", 0 }
+};
+
+static const guint bench_levels[] = {
+    AZTEC_CORRECTION_LOW,
+    AZTEC_CORRECTION_MEDIUM,
+    AZTEC_CORRECTION_HIGH,
+    AZTEC_CORRECTION_HIGHEST
+};
+
+static
+void
+bench_corpus_fill(
+    const BenchCorpus* corpus,
+    guint8* buf,
+    gsize len)
+{
+    gsize i;
+
+    if (corpus->pattern) {
+        const gsize n = strlen(corpus->pattern);
+
+        for (i = 0; i < len; i++) {
+            buf[i] = corpus->pattern[i % n];
+        }
+    } else {
+        guint32 seed = 12345;
+
+        for (i = 0; i < len; i++) {
+            seed = seed * 1103515245 + 12345;
+            buf[i] = (seed >> 16) % corpus->alphabet;
+            if (corpus->alphabet == 10) {
+                buf[i] += '0';
+            }
+        }
+    }
+}
+
+/* Everything the stages need, prepared by running the whole pipeline */
+
+typedef struct bench_case {
+    const BenchCorpus* corpus;
+    const guint8* data;
+    gsize len;
+    AztecEncodeOptions opts;
+    AztecBits* bits;
+    AztecConfig config;
+    guint data_count;
+    guint16* words;         /* Data and check codewords */
+    guint16* scratch;
+    AztecBits* symbol_bits;
+} BenchCase;
+
+typedef struct bench_stage {
+    const char* name;
+    void (*run)(BenchCase* c);
+} BenchStage;
+
+static
+gboolean
+bench_case_init(
+    BenchCase* c,
+    const BenchCorpus* corpus,
+    const guint8* data,
+    gsize len,
+    guint correction)
+{
+    AztecConfig prev;
+    AztecCodewords* cw = NULL;
+    AztecBits* bits;
+    AztecBits* mode;
+    guint bitcount, i;
+
+    memset(c, 0, sizeof(*c));
+    c->corpus = corpus;
+    c->data = data;
+    c->len = len;
+    aztec_encode_options_init(&c->opts, correction, 0);
+    c->bits = aztec_encode_data_bits(data, len);
+
+    bitcount = c->bits->count;
+    memset(&prev, 0, sizeof(prev));
+    while (aztec_encode_next_config(bitcount, &c->opts, &c->config, &prev)) {
+        aztec_codewords_free(cw, TRUE);
+        cw = aztec_encode_codewords(c->bits, c->config.cwsize);
+        bitcount = cw->count * c->config.cwsize;
+        prev = c->config;
+    }
+    if (!c->config.layers) {
+        aztec_codewords_free(cw, TRUE);
+        aztec_bits_free(c->bits);
+        return FALSE;
+    }
+
+    c->data_count = cw->count;
+    c->words = g_new0(guint16, c->config.cwcount);
+    c->scratch = g_new0(guint16, c->config.cwcount);
+    memcpy(c->words, cw->words, cw->count * sizeof(guint16));
+    aztec_codewords_free(cw, TRUE);
+    aztec_rs_encode16_full(c->config.gfpoly, 1, c->words, c->data_count,
+        c->words + c->data_count, c->config.cwcount - c->data_count);
+
+    bits = aztec_bits_new();
+    for (i = 0; i < c->config.cwcount; i++) {
+        aztec_bits_add_inv(bits, c->words[i], c->config.cwsize);
+    }
+    mode = c->config.encode_mode_message(c->config.layers, c->data_count);
+    c->symbol_bits = c->config.encode_symbol(c->config.symsize, bits, mode);
+    aztec_bits_free(mode);
+    aztec_bits_free(bits);
+    return TRUE;
+}
+
+static
+void
+bench_case_clear(
+    BenchCase* c)
+{
+    aztec_bits_free(c->bits);
+    aztec_bits_free(c->symbol_bits);
+    g_free(c->words);
+    g_free(c->scratch);
+}
+
+/* Segmentation into modes and bits */
+static
+void
+bench_stage_bits(
+    BenchCase* c)
+{
+    aztec_bits_free(aztec_encode_data_bits(c->data, c->len));
+}
+
+/* Configuration picks and bit stuffing rounds */
+static
+void
+bench_stage_codewords(
+    BenchCase* c)
+{
+    AztecConfig config, prev;
+    AztecCodewords* cw = NULL;
+    guint bitcount = c->bits->count;
+
+    memset(&prev, 0, sizeof(prev));
+    while (aztec_encode_next_config(bitcount, &c->opts, &config, &prev)) {
+        aztec_codewords_free(cw, TRUE);
+        cw = aztec_encode_codewords(c->bits, config.cwsize);
+        bitcount = cw->count * config.cwsize;
+        prev = config;
+    }
+    aztec_codewords_free(cw, TRUE);
+}
+
+/* Reed-Solomon check codewords */
+static
+void
+bench_stage_rs(
+    BenchCase* c)
+{
+    memcpy(c->scratch, c->words, c->data_count * sizeof(guint16));
+    aztec_rs_encode16_full(c->config.gfpoly, 1, c->scratch, c->data_count,
+        c->scratch + c->data_count, c->config.cwcount - c->data_count);
+}
+
+/* Mode message and module placement */
+static
+void
+bench_stage_place(
+    BenchCase* c)
+{
+    AztecBits* bits = aztec_bits_new();
+    AztecBits* mode;
+    guint i;
+
+    aztec_bits_reserve(bits, c->config.cwcount * c->config.cwsize);
+    for (i = 0; i < c->config.cwcount; i++) {
+        aztec_bits_add_inv(bits, c->words[i], c->config.cwsize);
+    }
+    mode = c->config.encode_mode_message(c->config.layers, c->data_count);
+    aztec_bits_free(c->config.encode_symbol(c->config.symsize, bits, mode));
+    aztec_bits_free(mode);
+    aztec_bits_free(bits);
+}
+
+/* Conversion into AztecSymbol rows */
+static
+void
+bench_stage_export(
+    BenchCase* c)
+{
+    aztec_symbol_free(aztec_encode_symbol_new(c->config.symsize,
+        c->symbol_bits, 0));
+}
+
+/* The whole thing, for reference */
+static
+void
+bench_stage_total(
+    BenchCase* c)
+{
+    aztec_symbol_free(aztec_encode_full(c->data, c->len, &c->opts));
+}
+
+static const BenchStage bench_stages[] = {
+    { "bits", bench_stage_bits },
+    { "codewords", bench_stage_codewords },
+    { "rs", bench_stage_rs },
+    { "place", bench_stage_place },
+    { "export", bench_stage_export },
+    { "total", bench_stage_total }
+};
+
+typedef struct bench_result {
+    guint64 iterations;
+    double ns;
+    double mbps;
+    double allocs;
+} BenchResult;
+
+static
+guint64
+bench_now(
+    void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Keeps doubling the iteration count until the run is long enough */
+static
+void
+bench_run(
+    BenchCase* c,
+    const BenchStage* stage,
+    guint64 min_ns,
+    BenchResult* result)
+{
+    guint64 n = 1, elapsed, allocs;
+
+    for (;;) {
+        const guint64 allocs0 = test_alloc_count();
+        const guint64 start = bench_now();
+        guint64 i;
+
+        for (i = 0; i < n; i++) {
+            stage->run(c);
+        }
+        elapsed = bench_now() - start;
+        allocs = test_alloc_count() - allocs0;
+        if (elapsed >= min_ns || n >= (G_GUINT64_CONSTANT(1) << 32)) {
+            break;
+        }
+        n = elapsed ? MAX(n * 2, MIN(n * 100, n * min_ns * 6 / 5 /
+            elapsed)) : (n * 100);
+    }
+    result->iterations = n;
+    result->ns = (double)elapsed / n;
+    result->mbps = c->len * 1000.0 / result->ns;
+    result->allocs = (double)allocs / n;
+}
+
+static
+void
+bench_print_header(
+    gboolean json)
+{
+    if (json) {
+        printf("[\n");
+    } else {
+        printf("%-10s %5s %4s %-10s %-10s %12s %10s %10s\n", "CORPUS",
+            "BYTES", "ECC", "SYMBOL", "STAGE", "NS/OP", "MB/S",
+            "ALLOCS/OP");
+    }
+}
+
+static
+void
+bench_print(
+    const BenchCase* c,
+    const BenchStage* stage,
+    const BenchResult* r,
+    gboolean json,
+    gboolean first)
+{
+    if (json) {
+        printf("%s  {\"corpus\": \"%s\", \"bytes\": %u, \"correction\": %u, "
+            "\"compact\": %s, \"layers\": %u, \"stage\": \"%s\", "
+            "\"iterations\": %" G_GUINT64_FORMAT ", \"ns_per_op\": %.1f, "
+            "\"mb_per_s\": %.2f, \"allocs_per_op\": %.2f}", first ? "" :
+            ",\n", c->corpus->name, (guint)c->len, c->opts.correction,
+            c->config.compact ? "true" : "false", c->config.layers,
+            stage->name, r->iterations, r->ns, r->mbps, r->allocs);
+    } else {
+        char symbol[16];
+
+        g_snprintf(symbol, sizeof(symbol), "%s%u", c->config.compact ?
+            "compact" : "full", c->config.layers);
+        printf("%-10s %5u %4u %-10s %-10s %12.1f %10.2f %10.2f\n",
+            c->corpus->name, (guint)c->len, c->opts.correction, symbol,
+            stage->name, r->ns, r->mbps, r->allocs);
+    }
+    fflush(stdout);
+}
+
+int
+main(
+    int argc,
+    char* argv[])
+{
+    int ret = RET_ERR;
+    int ms = 20;
+    gboolean json = FALSE;
+    const char* filter = NULL;
+    GError* error = NULL;
+    GOptionContext* options;
+    GOptionEntry entries[] = {
+        { "time", 't', 0, G_OPTION_ARG_INT, &ms,
+          "Minimum run time per measurement [20]", "MS" },
+        { "corpus", 'c', 0, G_OPTION_ARG_STRING, &filter,
+          "Only run the specified corpus", "NAME" },
+        { "json", 'J', 0, G_OPTION_ARG_NONE, &json,
+          "Print results as JSON", NULL },
+        { NULL }
+    };
+
+    /* Slices have to come from malloc to be counted */
+    test_alloc_init(argv);
+
+    options = g_option_context_new(NULL);
+    g_option_context_add_main_entries(options, entries, NULL);
+    g_option_context_set_summary(options, "Times the encoder stages for "
+        "each corpus, payload size and error\ncorrection level. "
+        "Corpora: upper, lower, punct, digits, url, bcbp,\nbinary and "
+        "alternate.");
+    if (g_option_context_parse(options, &argc, &argv, &error) &&
+        argc == 1 && ms > 0) {
+        const gsize sizes[] = { BENCH_SHORT, BENCH_LONG };
+        guint8* buf = g_malloc(BENCH_LONG);
+        gboolean first = TRUE;
+        guint i, j, k, l;
+
+        ret = RET_OK;
+        bench_print_header(json);
+        for (i = 0; i < G_N_ELEMENTS(bench_corpora); i++) {
+            const BenchCorpus* corpus = bench_corpora + i;
+
+            if (filter && strcmp(filter, corpus->name)) {
+                continue;
+            }
+            for (j = 0; j < G_N_ELEMENTS(sizes); j++) {
+                bench_corpus_fill(corpus, buf, sizes[j]);
+                for (k = 0; k < G_N_ELEMENTS(bench_levels); k++) {
+                    BenchCase c;
+
+                    if (!bench_case_init(&c, corpus, buf, sizes[j],
+                        bench_levels[k])) {
+                        fprintf(stderr, "%s/%u/%u doesn't fit\n",
+                            corpus->name, (guint)sizes[j], bench_levels[k]);
+                        ret = RET_ERR;
+                        continue;
+                    }
+                    for (l = 0; l < G_N_ELEMENTS(bench_stages); l++) {
+                        BenchResult r;
+
+                        bench_run(&c, bench_stages + l, ms * 1000000ULL, &r);
+                        bench_print(&c, bench_stages + l, &r, json, first);
+                        first = FALSE;
+                    }
+                    bench_case_clear(&c);
+                }
+            }
+        }
+        if (json) {
+            printf("\n]\n");
+        }
+        g_free(buf);
+    } else {
+        if (error) {
+            fprintf(stderr, "%s\n", error->message);
+            g_error_free(error);
+        } else {
+            char* help = g_option_context_get_help(options, TRUE, NULL);
+            fprintf(stderr, "%s", help);
+            g_free(help);
+        }
+        ret = RET_CMDLINE;
+    }
+    g_option_context_free(options);
+    return ret;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019 by Slava Monich <slava@monich.com>
+ * Copyright (C) 2019-2026 by Slava Monich <slava@monich.com>
  *
  * You may use this file under the terms of the BSD license as follows:
  *
@@ -68,10 +68,211 @@ aztec_encode_inv(
     gsize len,
     guint correct); /* Since 1.0.2 */
 
+/*
+ * Encoding options. By default the smallest symbol which can hold the
+ * data is chosen. The layout and layer count constraints allow to pin
+ * the symbol geometry (e.g. for the whole print run). Zero min_layers
+ * and max_layers mean no constraints, max_layers of 32 and above is the
+ * same as zero. Unknown layout, min_layers above 32 or above (non-zero)
+ * max_layers make encoding fail. The capacity of a symbol larger
+ * than necessary is used for extra error correction codewords. NULL
+ * options are equivalent to AZTEC_CORRECTION_DEFAULT and no flags.
+ */
+#define AZTEC_ENCODE_INV (0x01) /* Bit order of aztec_encode_inv() */
+
+#define AZTEC_LAYOUT_ANY (0)
+#define AZTEC_LAYOUT_COMPACT (1)
+#define AZTEC_LAYOUT_FULL (2)
+
+typedef struct aztec_encode_options {
+    guint correction;
+    guint flags;
+    guint layout;
+    guint min_layers;
+    guint max_layers;
+} AztecEncodeOptions; /* Since 1.0.10 */
+
+AztecSymbol*
+aztec_encode_with_options(
+    const void* data,
+    gsize len,
+    const AztecEncodeOptions* options); /* Since 1.0.10 */
+
+/*
+ * Answers the question whether the data fits into a symbol (and which
+ * one) without actually encoding it. Returns FALSE if the data is too
+ * long, in which case only the bits field is filled in.
+ */
+typedef struct aztec_encode_info {
+    guint bits;         /* Segmented data bits (before bit stuffing) */
+    gboolean compact;   /* Compact or full-range symbol */
+    guint layers;       /* Number of data layers */
+    guint size;         /* Symbol size (width and height) in modules */
+    guint cwsize;       /* Codeword size in bits */
+    guint cwcount;      /* Total number of codewords */
+    guint data_cwcount; /* Data codewords (after bit stuffing) */
+} AztecEncodeInfo; /* Since 1.0.10 */
+
+gboolean
+aztec_encode_measure(
+    const void* data,
+    gsize len,
+    guint correct,
+    AztecEncodeInfo* info); /* Since 1.0.10 */
+
+gboolean
+aztec_encode_measure_with_options(
+    const void* data,
+    gsize len,
+    const AztecEncodeOptions* options,
+    AztecEncodeInfo* info); /* Since 1.0.10 */
+
+AztecSymbol*
+aztec_symbol_ref(
+    AztecSymbol* symbol); /* Since 1.0.10 */
+
 void
 aztec_symbol_free(
     AztecSymbol* symbol);
 
+/*
+ * Released symbols are cached by the thread calling aztec_symbol_free()
+ * and reused by the subsequent aztec_encode() calls made by the same
+ * thread. The limit (64K by default) applies to each thread separately.
+ * Setting it to zero disables the caching. aztec_symbol_pool_trim()
+ * releases the symbols cached by the calling thread.
+ */
+void
+aztec_symbol_pool_set_limit(
+    gsize bytes); /* Since 1.0.10 */
+
+gsize
+aztec_symbol_pool_get_limit(
+    void); /* Since 1.0.10 */
+
+void
+aztec_symbol_pool_trim(
+    void); /* Since 1.0.10 */
+
+/*
+ * Batch encoding. Items are distributed between the specified number
+ * of threads (zero means one per CPU core), the calling thread being
+ * one of them. aztec_encode_batch() returns the array of count symbols
+ * (NULL if the corresponding item couldn't be encoded), which can be
+ * deallocated with aztec_symbol_batch_free(). aztec_encode_batch_foreach()
+ * passes each symbol to the callback as soon as it's ready. The callback
+ * is invoked on the worker threads in no particular order and takes
+ * ownership of the symbol.
+ */
+typedef struct aztec_batch_item {
+    const void* data;
+    gsize len;
+    guint correction;
+} AztecBatchItem; /* Since 1.0.10 */
+
+typedef
+void
+(*AztecBatchFunc)(
+    guint index,
+    AztecSymbol* symbol,
+    gpointer user_data); /* Since 1.0.10 */
+
+AztecSymbol**
+aztec_encode_batch(
+    const AztecBatchItem* items,
+    guint count,
+    guint flags,
+    guint threads); /* Since 1.0.10 */
+
+void
+aztec_encode_batch_foreach(
+    const AztecBatchItem* items,
+    guint count,
+    guint flags,
+    guint threads,
+    AztecBatchFunc func,
+    gpointer user_data); /* Since 1.0.10 */
+
+void
+aztec_symbol_batch_free(
+    AztecSymbol** symbols,
+    guint count); /* Since 1.0.10 */
+
+/*
+ * Process-wide cache of encoded symbols, keyed by the payload and the
+ * encoding options. Disabled by default, enabled by setting a non-zero
+ * size limit. Symbols returned from the cache are shared (reference
+ * counted), the caller must not modify them. Setting the limit to zero
+ * disables the cache and drops everything it holds.
+ */
+typedef struct aztec_cache_stats {
+    guint64 hits;
+    guint64 misses;
+    guint64 evictions;
+    gsize bytes;
+    guint count;
+} AztecCacheStats; /* Since 1.0.10 */
+
+void
+aztec_cache_set_limit(
+    gsize bytes); /* Since 1.0.10 */
+
+gsize
+aztec_cache_get_limit(
+    void); /* Since 1.0.10 */
+
+void
+aztec_cache_clear(
+    void); /* Since 1.0.10 */
+
+void
+aztec_cache_get_stats(
+    AztecCacheStats* stats); /* Since 1.0.10 */
+
+/*
+ * Encoder instrumentation, only available if the library is built with
+ * AZTEC_STATS=1. Each thread updates its own counters without locking,
+ * aztec_stats_snapshot() adds up the counters of all threads (including
+ * the ones which have already finished) and returns FALSE (filling the
+ * stats with zeros) if the library was built without instrumentation.
+ * Segmentation and configuration counters include the work done by
+ * aztec_encode_measure(), the rest only counts the symbols actually
+ * encoded (cache hits aren't). Elapsed times are in nanoseconds.
+ */
+typedef enum aztec_stage {
+    AZTEC_STAGE_SEGMENT,    /* Splitting the data into modes, data bits */
+    AZTEC_STAGE_CONFIG,     /* Picking the symbol configuration */
+    AZTEC_STAGE_STUFF,      /* Bit stuffing the data into codewords */
+    AZTEC_STAGE_RS,         /* Check codewords */
+    AZTEC_STAGE_MODE,       /* Codeword repacking, mode message */
+    AZTEC_STAGE_PLACE,      /* Module placement */
+    AZTEC_STAGE_EXPORT,     /* Conversion into AztecSymbol rows */
+    AZTEC_STAGE_COUNT
+} AztecStage; /* Since 1.0.10 */
+
+typedef struct aztec_stats {
+    guint64 encodes;        /* Symbols encoded */
+    guint64 bytes;          /* Payload bytes encoded */
+    guint64 blocks;         /* Segmentation blocks */
+    guint64 latches;        /* Mode latches */
+    guint64 shifts;         /* Mode shifts (including binary shifts) */
+    guint64 stuffing_rounds;/* Passes of bit stuffing */
+    guint64 stuffed_bits;   /* Bits added by stuffing and padding */
+    guint64 config_picks;   /* Symbol configuration lookups */
+    guint64 config_iterations; /* Symbol sizes tried by those lookups */
+    guint64 codewords;      /* Data and check codewords */
+    guint64 ns[AZTEC_STAGE_COUNT];
+} AztecStats; /* Since 1.0.10 */
+
+gboolean
+aztec_stats_snapshot(
+    AztecStats* stats); /* Since 1.0.10 */
+
+/*
+ * Any error correction percentage between AZTEC_CORRECTION_LOW and
+ * AZTEC_CORRECTION_HIGHEST is accepted since 1.0.10, values outside
+ * of that range are clamped.
+ */
 #define AZTEC_CORRECTION_LOW (10)
 #define AZTEC_CORRECTION_MEDIUM (23)
 #define AZTEC_CORRECTION_HIGH (36)
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef AZTEC_ENCODE_ASYNC_H
+#define AZTEC_ENCODE_ASYNC_H
+
+#include "aztec_encode.h"
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Asynchronous version of aztec_encode() and aztec_encode_inv(). The
+ * data are copied, the caller doesn't need to keep them around. The
+ * encoding is done by the GIO worker pool, the callback is invoked by
+ * the thread-default main context of the calling thread. The callback
+ * should call aztec_encode_finish() to get the result. The symbol is
+ * to be deallocated with aztec_symbol_free().
+ */
+
+#define AZTEC_ENCODE_ERROR (aztec_encode_error_quark())
+
+typedef enum aztec_encode_error {
+    AZTEC_ENCODE_ERROR_TOO_MUCH_DATA
+} AztecEncodeError; /* Since 1.0.10 */
+
+GQuark
+aztec_encode_error_quark(
+    void); /* Since 1.0.10 */
+
+void
+aztec_encode_async(
+    const void* data,
+    gsize len,
+    guint correct,
+    guint flags,
+    GCancellable* cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data); /* Since 1.0.10 */
+
+AztecSymbol*
+aztec_encode_finish(
+    GAsyncResult* result,
+    GError** error); /* Since 1.0.10 */
+
+G_END_DECLS
+
+#endif /* AZTEC_ENCODE_ASYNC_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
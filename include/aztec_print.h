@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef AZTEC_PRINT_H
+#define AZTEC_PRINT_H
+
+#include "aztec_encode.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Raster graphics for label and receipt printers. The symbol is scaled
+ * and surrounded by the quiet zone exactly like aztec_symbol_render()
+ * does it, each row is padded to a whole number of bytes with white
+ * (unprinted) pixels. Both functions return NULL if scale is zero.
+ *
+ * aztec_symbol_zpl() produces the ZPL ^GFA command (without the field
+ * origin and separator), the returned string is to be deallocated with
+ * g_free(). AZTEC_ZPL_HEX is plain ASCII hex, AZTEC_ZPL_ACS is ASCII
+ * hex with ZPL compression (repeat counts, ',' '!' and ':' shortcuts)
+ * and AZTEC_ZPL_Z64 is :Z64: encoding (zlib, base64 and CRC).
+ *
+ * aztec_symbol_escpos() produces ESC/POS GS v 0 raster bit image
+ * commands, each covering at most max_rows rows (zero meaning that
+ * the whole image is sent as a single command).
+ */
+typedef enum aztec_zpl_format {
+    AZTEC_ZPL_HEX,
+    AZTEC_ZPL_ACS,
+    AZTEC_ZPL_Z64
+} AztecZplFormat; /* Since 1.0.10 */
+
+char*
+aztec_symbol_zpl(
+    const AztecSymbol* symbol,
+    AztecZplFormat format,
+    guint scale,
+    guint border); /* Since 1.0.10 */
+
+GBytes*
+aztec_symbol_escpos(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border,
+    guint max_rows); /* Since 1.0.10 */
+
+G_END_DECLS
+
+#endif /* AZTEC_PRINT_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
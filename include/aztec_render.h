@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef AZTEC_RENDER_H
+#define AZTEC_RENDER_H
+
+#include "aztec_encode.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Exports the symbol into the caller-provided surface, one pixel per
+ * module. The stride is the distance between the rows in bytes. The
+ * dark and light colors are 0xAARRGGBB values, AZTEC_PIXEL_GRAY8 uses
+ * the lowest byte, 1-bpp formats ignore the colors (dark modules are
+ * ones). 32-bit formats expect pixels and stride to be 4-byte aligned.
+ * Returns FALSE if the format is unknown or the stride is too small
+ * for the symbol.
+ */
+typedef enum aztec_pixel_format {
+    AZTEC_PIXEL_MONO_LSB, /* 1 bpp, left-most pixel in the LSB */
+    AZTEC_PIXEL_MONO_MSB, /* 1 bpp, left-most pixel in the MSB */
+    AZTEC_PIXEL_GRAY8,    /* 8 bpp */
+    AZTEC_PIXEL_ARGB32,   /* Native endian 32-bit words (cairo, Qt) */
+    AZTEC_PIXEL_RGBA32    /* R, G, B, A bytes */
+} AztecPixelFormat; /* Since 1.0.10 */
+
+#define AZTEC_COLOR_BLACK (0xff000000)
+#define AZTEC_COLOR_WHITE (0xffffffff)
+
+gboolean
+aztec_symbol_export(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    guint32 dark,
+    guint32 light,
+    void* pixels,
+    gsize stride); /* Since 1.0.10 */
+
+/*
+ * Renders the symbol scaled by an integer factor and surrounded by
+ * the quiet zone of the specified number of modules, one bit per pixel
+ * (dark pixels are ones). The image is (size + 2 * border) * scale
+ * pixels wide and high. Each distinct row is passed to the callback
+ * only once, along with the number of times it's repeated. The row
+ * buffer is only valid during the callback. The callback may return
+ * FALSE to stop the rendering, in which case aztec_symbol_render()
+ * returns FALSE too. Only 1-bpp formats are supported.
+ */
+typedef
+gboolean
+(*AztecRenderFunc)(
+    const guint8* row,
+    gsize rowsize,
+    guint repeat,
+    gpointer user_data); /* Since 1.0.10 */
+
+gboolean
+aztec_symbol_render(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    guint scale,
+    guint border,
+    AztecRenderFunc func,
+    gpointer user_data); /* Since 1.0.10 */
+
+/*
+ * Pull-style version of aztec_symbol_render(). Each call to
+ * aztec_row_reader_next() renders the next distinct row into the
+ * internal buffer and returns it along with the repeat count, NULL
+ * marks the end of the image. The reader doesn't hold a reference
+ * to the symbol, the symbol must stay alive until the reader is freed.
+ *
+ * aztec_row_reader_new_sheet() lays out count symbols on a grid with
+ * the specified number of columns, row by row. All cells have the same
+ * size, large enough for the largest symbol and its quiet zone, smaller
+ * symbols are centered in their cells and NULL entries leave the cells
+ * empty. Each output row is assembled from the matching rows of all
+ * symbols in the band, so the sheet is never held in memory as a whole.
+ * The symbols must stay alive until the reader is freed, the array may
+ * be freed right away.
+ */
+typedef struct aztec_row_reader AztecRowReader; /* Since 1.0.10 */
+
+AztecRowReader*
+aztec_row_reader_new(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    guint scale,
+    guint border); /* Since 1.0.10 */
+
+AztecRowReader*
+aztec_row_reader_new_sheet(
+    const AztecSymbol* const* symbols,
+    guint count,
+    guint columns,
+    AztecPixelFormat format,
+    guint scale,
+    guint border); /* Since 1.0.10 */
+
+void
+aztec_row_reader_free(
+    AztecRowReader* reader); /* Since 1.0.10 */
+
+guint
+aztec_row_reader_width(
+    const AztecRowReader* reader); /* Since 1.0.10 */
+
+guint
+aztec_row_reader_height(
+    const AztecRowReader* reader); /* Since 1.0.10 */
+
+gsize
+aztec_row_reader_rowsize(
+    const AztecRowReader* reader); /* Since 1.0.10 */
+
+AztecPixelFormat
+aztec_row_reader_format(
+    const AztecRowReader* reader); /* Since 1.0.10 */
+
+const guint8*
+aztec_row_reader_next(
+    AztecRowReader* reader,
+    guint* repeat); /* Since 1.0.10 */
+
+/*
+ * Passes unscaled symbol rows (one bit per module) to the callback in
+ * the requested bit order, converting them on the fly if necessary.
+ * Stops and returns FALSE if the callback returns FALSE.
+ */
+typedef
+gboolean
+(*AztecSymbolRowFunc)(
+    guint y,
+    const guint8* row,
+    gsize rowsize,
+    gpointer user_data); /* Since 1.0.10 */
+
+gboolean
+aztec_symbol_foreach_row(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    AztecSymbolRowFunc func,
+    gpointer user_data); /* Since 1.0.10 */
+
+/*
+ * Vector representation of the symbol. aztec_symbol_runs() returns
+ * the horizontal runs of dark modules (all of height 1), ordered by
+ * y then x. aztec_symbol_rects() merges the runs which have the same
+ * horizontal position in the adjacent rows into rectangles, ordered
+ * by their top left corner. The coordinates are in modules. Either
+ * way, dark modules are covered exactly once. The returned array is
+ * to be deallocated with g_free().
+ */
+typedef struct aztec_rect {
+    guint x;
+    guint y;
+    guint width;
+    guint height;
+} AztecRect; /* Since 1.0.10 */
+
+AztecRect*
+aztec_symbol_runs(
+    const AztecSymbol* symbol,
+    guint* count); /* Since 1.0.10 */
+
+AztecRect*
+aztec_symbol_rects(
+    const AztecSymbol* symbol,
+    guint* count); /* Since 1.0.10 */
+
+G_END_DECLS
+
+#endif /* AZTEC_RENDER_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
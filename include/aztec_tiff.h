@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef AZTEC_TIFF_H
+#define AZTEC_TIFF_H
+
+#include "aztec_render.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Bilevel images compressed with CCITT Group 4 (T.6) coding. The
+ * symbol is scaled and surrounded by the quiet zone exactly like
+ * aztec_symbol_render() does it. Both functions return NULL if scale
+ * is zero.
+ *
+ * aztec_symbol_g4() returns the bare T.6 bit stream (MSB first, no
+ * byte alignment of the rows, terminated with EOFB). aztec_symbol_tiff()
+ * wraps it into a single strip little-endian TIFF file with WhiteIsZero
+ * photometric interpretation. Zero dpi leaves the resolution unit
+ * unspecified.
+ *
+ * aztec_row_reader_g4() and aztec_row_reader_tiff() do the same for
+ * the rows remaining in the reader (e.g. a sheet of symbols). The reader
+ * must produce AZTEC_PIXEL_MONO_MSB rows, NULL is returned otherwise.
+ */
+GBytes*
+aztec_symbol_g4(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border); /* Since 1.0.10 */
+
+GBytes*
+aztec_symbol_tiff(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border,
+    guint dpi); /* Since 1.0.10 */
+
+GBytes*
+aztec_row_reader_g4(
+    AztecRowReader* reader); /* Since 1.0.10 */
+
+GBytes*
+aztec_row_reader_tiff(
+    AztecRowReader* reader,
+    guint dpi); /* Since 1.0.10 */
+
+G_END_DECLS
+
+#endif /* AZTEC_TIFF_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
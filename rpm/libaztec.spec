@@ -10,7 +10,9 @@ Source: %{name}-%{version}.tar.bz2
 
 BuildRequires: pkgconfig
 BuildRequires: pkgconfig(libpng)
+BuildRequires: pkgconfig(zlib)
 BuildRequires: pkgconfig(glib-2.0)
+BuildRequires: pkgconfig(gio-2.0)
 Requires(post): /sbin/ldconfig
 Requires(postun): /sbin/ldconfig
 
@@ -62,5 +64,8 @@ make test
 
 %files -n aztec-tools
 %defattr(-,root,root,-)
+%{_bindir}/aztec-pbm
 %{_bindir}/aztec-png
+%{_bindir}/aztec-printer
+%{_bindir}/aztec-server
 %{_bindir}/aztec-svg
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_encode.h"
+
+/*
+ * Each worker owns a contiguous range of items and takes them one by
+ * one from the front. A worker that runs out of items steals the upper
+ * half of the largest remaining range. Payloads in a batch can differ
+ * in size by orders of magnitude, that keeps all workers busy until the
+ * very end.
+ */
+
+/*
+ * begin and end are only modified under the mutex but are also peeked
+ * at without it when picking a victim, hence the atomic stores.
+ */
+typedef struct aztec_batch_worker {
+    GMutex mutex;
+    guint begin;
+    guint end;
+} AztecBatchWorker;
+
+typedef struct aztec_batch {
+    const AztecBatchItem* items;
+    guint flags;
+    AztecBatchFunc func;
+    gpointer user_data;
+    AztecBatchWorker* workers;
+    guint nworkers;
+} AztecBatch;
+
+typedef struct aztec_batch_thread {
+    AztecBatch* batch;
+    guint index;
+} AztecBatchThread;
+
+static
+gboolean
+aztec_batch_next(
+    AztecBatchWorker* worker,
+    guint* index)
+{
+    gboolean ok = FALSE;
+
+    g_mutex_lock(&worker->mutex);
+    if (worker->begin < worker->end) {
+        *index = worker->begin;
+        g_atomic_int_set(&worker->begin, worker->begin + 1);
+        ok = TRUE;
+    }
+    g_mutex_unlock(&worker->mutex);
+    return ok;
+}
+
+static
+gboolean
+aztec_batch_steal(
+    AztecBatch* batch,
+    AztecBatchWorker* thief)
+{
+    while (TRUE) {
+        AztecBatchWorker* victim = NULL;
+        guint i, max = 0;
+
+        /* Pick the victim without locking, then double-check */
+        for (i = 0; i < batch->nworkers; i++) {
+            AztecBatchWorker* worker = batch->workers + i;
+            const guint begin = g_atomic_int_get(&worker->begin);
+            const guint end = g_atomic_int_get(&worker->end);
+
+            if (worker != thief && end > begin && (end - begin) > max) {
+                max = end - begin;
+                victim = worker;
+            }
+        }
+
+        if (victim) {
+            guint begin = 0, end = 0;
+
+            g_mutex_lock(&victim->mutex);
+            if (victim->end > victim->begin) {
+                /*
+                 * The item being encoded by the victim has already been
+                 * taken off its range, everything left there is up for
+                 * grabs.
+                 */
+                const guint n = (victim->end - victim->begin + 1) / 2;
+
+                end = victim->end;
+                begin = end - n;
+                g_atomic_int_set(&victim->end, begin);
+            }
+            g_mutex_unlock(&victim->mutex);
+
+            if (begin < end) {
+                g_mutex_lock(&thief->mutex);
+                g_atomic_int_set(&thief->begin, begin);
+                g_atomic_int_set(&thief->end, end);
+                g_mutex_unlock(&thief->mutex);
+                return TRUE;
+            }
+            /* Someone else got there first, try another victim */
+        } else {
+            /* Nothing left */
+            return FALSE;
+        }
+    }
+}
+
+static
+void
+aztec_batch_run(
+    AztecBatch* batch,
+    guint index)
+{
+    AztecBatchWorker* worker = batch->workers + index;
+    const AztecBatchItem* items = batch->items;
+    const gboolean inv = (batch->flags & AZTEC_ENCODE_INV) != 0;
+
+    do {
+        guint i;
+
+        while (aztec_batch_next(worker, &i)) {
+            const AztecBatchItem* item = items + i;
+
+            batch->func(i, inv ?
+                aztec_encode_inv(item->data, item->len, item->correction) :
+                aztec_encode(item->data, item->len, item->correction),
+                batch->user_data);
+        }
+    } while (aztec_batch_steal(batch, worker));
+}
+
+static
+gpointer
+aztec_batch_thread(
+    gpointer data)
+{
+    AztecBatchThread* thread = data;
+
+    aztec_batch_run(thread->batch, thread->index);
+    return NULL;
+}
+
+static
+void
+aztec_batch_store(
+    guint index,
+    AztecSymbol* symbol,
+    gpointer user_data)
+{
+    AztecSymbol** symbols = user_data;
+
+    symbols[index] = symbol;
+}
+
+void
+aztec_encode_batch_foreach(
+    const AztecBatchItem* items,
+    guint count,
+    guint flags,
+    guint threads,
+    AztecBatchFunc func,
+    gpointer user_data) /* Since 1.0.10 */
+{
+    if (count && func) {
+        AztecBatch batch;
+        GThread** thread;
+        AztecBatchThread* data;
+        guint i, n;
+
+        if (!threads) {
+            threads = g_get_num_processors();
+        }
+        n = MIN(threads, count);
+
+        batch.items = items;
+        batch.flags = flags;
+        batch.func = func;
+        batch.user_data = user_data;
+        batch.nworkers = n;
+        batch.workers = g_new(AztecBatchWorker, n);
+
+        /* Start with equal shares */
+        for (i = 0; i < n; i++) {
+            AztecBatchWorker* worker = batch.workers + i;
+
+            g_mutex_init(&worker->mutex);
+            worker->begin = (guint)((guint64)count * i / n);
+            worker->end = (guint)((guint64)count * (i + 1) / n);
+        }
+
+        /* The calling thread is worker #0 */
+        thread = g_new(GThread*, n);
+        data = g_new(AztecBatchThread, n);
+        for (i = 1; i < n; i++) {
+            data[i].batch = &batch;
+            data[i].index = i;
+            thread[i] = g_thread_new("aztec-batch", aztec_batch_thread,
+                data + i);
+        }
+        aztec_batch_run(&batch, 0);
+        for (i = 1; i < n; i++) {
+            g_thread_join(thread[i]);
+        }
+
+        for (i = 0; i < n; i++) {
+            g_mutex_clear(&batch.workers[i].mutex);
+        }
+        g_free(batch.workers);
+        g_free(thread);
+        g_free(data);
+    }
+}
+
+AztecSymbol**
+aztec_encode_batch(
+    const AztecBatchItem* items,
+    guint count,
+    guint flags,
+    guint threads) /* Since 1.0.10 */
+{
+    AztecSymbol** symbols = g_new0(AztecSymbol*, count);
+
+    aztec_encode_batch_foreach(items, count, flags, threads,
+        aztec_batch_store, symbols);
+    return symbols;
+}
+
+void
+aztec_symbol_batch_free(
+    AztecSymbol** symbols,
+    guint count) /* Since 1.0.10 */
+{
+    if (symbols) {
+        guint i;
+
+        for (i = 0; i < count; i++) {
+            aztec_symbol_free(symbols[i]);
+        }
+        g_free(symbols);
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_cache.h"
+#include "aztec_symbol.h"
+
+#include <string.h>
+
+/*
+ * The cache is split into independently locked shards, the shard is
+ * selected by the hash of the key. Each shard maintains its own LRU
+ * list and gets an equal share of the size limit.
+ */
+
+#define AZTEC_CACHE_SHARD_BITS (4)
+#define AZTEC_CACHE_SHARDS (1 << AZTEC_CACHE_SHARD_BITS)
+#define AZTEC_CACHE_SHARD_MASK (AZTEC_CACHE_SHARDS - 1)
+
+typedef struct aztec_cache_entry {
+    AztecCacheKey key; /* Must be first */
+    GList link;
+    AztecSymbol* symbol;
+    gsize bytes;
+} AztecCacheEntry;
+
+typedef struct aztec_cache_shard {
+    GMutex mutex;
+    GHashTable* table;
+    GQueue lru; /* Most recently used first */
+    gsize bytes;
+    guint64 hits;
+    guint64 misses;
+    guint64 evictions;
+} AztecCacheShard;
+
+static AztecCacheShard aztec_cache_shards[AZTEC_CACHE_SHARDS];
+static gsize aztec_cache_limit = 0;
+
+static
+inline
+guint64
+aztec_cache_mix(
+    guint64 h)
+{
+    h ^= h >> 33;
+    h *= G_GUINT64_CONSTANT(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    return h;
+}
+
+static
+guint
+aztec_cache_hash_data(
+    const guint8* data,
+    gsize len,
+    guint seed)
+{
+    const guint64 m = G_GUINT64_CONSTANT(0xc6a4a7935bd1e995);
+    guint64 h = seed ^ (len * m);
+    guint64 w;
+
+    while (len >= 8) {
+        memcpy(&w, data, 8);
+        h = (h ^ aztec_cache_mix(w)) * m;
+        data += 8;
+        len -= 8;
+    }
+    if (len) {
+        w = 0;
+        memcpy(&w, data, len);
+        h = (h ^ aztec_cache_mix(w)) * m;
+    }
+    return (guint)aztec_cache_mix(h);
+}
+
+static
+guint
+aztec_cache_key_hash(
+    gconstpointer key)
+{
+    return ((const AztecCacheKey*)key)->hash;
+}
+
+static
+gboolean
+aztec_cache_key_equal(
+    gconstpointer a,
+    gconstpointer b)
+{
+    const AztecCacheKey* k1 = a;
+    const AztecCacheKey* k2 = b;
+
+    return k1->hash == k2->hash &&
+        k1->len == k2->len &&
+        k1->correction == k2->correction &&
+        k1->flags == k2->flags &&
+        k1->layout == k2->layout &&
+        !memcmp(k1->data, k2->data, k1->len);
+}
+
+static
+void
+aztec_cache_entry_free(
+    AztecCacheEntry* entry)
+{
+    aztec_symbol_free(entry->symbol);
+    g_free(entry);
+}
+
+static
+gsize
+aztec_cache_shard_limit(
+    void)
+{
+    return g_atomic_pointer_get(&aztec_cache_limit) / AZTEC_CACHE_SHARDS;
+}
+
+static
+void
+aztec_cache_shard_remove(
+    AztecCacheShard* shard,
+    AztecCacheEntry* entry)
+{
+    g_hash_table_remove(shard->table, &entry->key);
+    g_queue_unlink(&shard->lru, &entry->link);
+    shard->bytes -= entry->bytes;
+    aztec_cache_entry_free(entry);
+}
+
+/* Called under lock */
+static
+void
+aztec_cache_shard_shrink(
+    AztecCacheShard* shard,
+    gsize limit)
+{
+    while (shard->bytes > limit) {
+        GList* last = shard->lru.tail;
+
+        aztec_cache_shard_remove(shard, last->data);
+        shard->evictions++;
+    }
+}
+
+gboolean
+aztec_cache_enabled(
+    void)
+{
+    return g_atomic_pointer_get(&aztec_cache_limit) != 0;
+}
+
+void
+aztec_cache_key_init(
+    AztecCacheKey* key,
+    const void* data,
+    gsize len,
+    const AztecEncodeOptions* opts)
+{
+    key->data = data;
+    key->len = len;
+    key->correction = opts->correction;
+    key->flags = opts->flags;
+    /* The options have been checked, these all fit into a byte */
+    key->layout = (opts->layout & 0xff) |
+        ((opts->min_layers & 0xff) << 8) |
+        ((opts->max_layers & 0xff) << 16);
+    key->hash = aztec_cache_hash_data(data, len, (key->layout << 12) ^
+        (key->correction << 4) ^ key->flags);
+}
+
+AztecSymbol*
+aztec_cache_lookup(
+    const AztecCacheKey* key)
+{
+    AztecCacheShard* shard = aztec_cache_shards +
+        (key->hash & AZTEC_CACHE_SHARD_MASK);
+    AztecCacheEntry* entry;
+    AztecSymbol* symbol = NULL;
+
+    g_mutex_lock(&shard->mutex);
+    entry = shard->table ? g_hash_table_lookup(shard->table, key) : NULL;
+    if (entry) {
+        /* Move it to the head of the LRU list */
+        g_queue_unlink(&shard->lru, &entry->link);
+        g_queue_push_head_link(&shard->lru, &entry->link);
+        symbol = aztec_symbol_ref(entry->symbol);
+        shard->hits++;
+    } else {
+        shard->misses++;
+    }
+    g_mutex_unlock(&shard->mutex);
+    return symbol;
+}
+
+void
+aztec_cache_insert(
+    const AztecCacheKey* key,
+    AztecSymbol* symbol)
+{
+    AztecCacheShard* shard = aztec_cache_shards +
+        (key->hash & AZTEC_CACHE_SHARD_MASK);
+    const gsize bytes = sizeof(AztecCacheEntry) + key->len +
+        aztec_symbol_bytes(symbol);
+
+    if (bytes <= aztec_cache_shard_limit()) {
+        gsize limit;
+
+        g_mutex_lock(&shard->mutex);
+        if (!shard->table) {
+            shard->table = g_hash_table_new(aztec_cache_key_hash,
+                aztec_cache_key_equal);
+        }
+
+        /*
+         * The limit may have been lowered in the meantime. The new limit
+         * is stored before the shards are shrunk under their locks, so
+         * the value read under the lock is current. Another thread may
+         * have inserted the same key too.
+         */
+        limit = aztec_cache_shard_limit();
+        if (bytes <= limit && !g_hash_table_lookup(shard->table, key)) {
+            AztecCacheEntry* entry = g_malloc(sizeof(AztecCacheEntry) +
+                key->len);
+            guint8* data = (guint8*)(entry + 1);
+
+            memcpy(data, key->data, key->len);
+            entry->key = *key;
+            entry->key.data = data;
+            entry->link.data = entry;
+            entry->link.prev = entry->link.next = NULL;
+            entry->symbol = aztec_symbol_ref(symbol);
+            entry->bytes = bytes;
+
+            g_hash_table_add(shard->table, &entry->key);
+            g_queue_push_head_link(&shard->lru, &entry->link);
+            shard->bytes += bytes;
+            aztec_cache_shard_shrink(shard, limit);
+        }
+        g_mutex_unlock(&shard->mutex);
+    }
+}
+
+void
+aztec_cache_set_limit(
+    gsize bytes) /* Since 1.0.10 */
+{
+    guint i;
+
+    g_atomic_pointer_set(&aztec_cache_limit, bytes);
+    for (i = 0; i < AZTEC_CACHE_SHARDS; i++) {
+        AztecCacheShard* shard = aztec_cache_shards + i;
+
+        g_mutex_lock(&shard->mutex);
+        aztec_cache_shard_shrink(shard, bytes / AZTEC_CACHE_SHARDS);
+        g_mutex_unlock(&shard->mutex);
+    }
+}
+
+gsize
+aztec_cache_get_limit(
+    void) /* Since 1.0.10 */
+{
+    return g_atomic_pointer_get(&aztec_cache_limit);
+}
+
+void
+aztec_cache_clear(
+    void) /* Since 1.0.10 */
+{
+    guint i;
+
+    for (i = 0; i < AZTEC_CACHE_SHARDS; i++) {
+        AztecCacheShard* shard = aztec_cache_shards + i;
+
+        g_mutex_lock(&shard->mutex);
+        while (shard->lru.head) {
+            aztec_cache_shard_remove(shard, shard->lru.head->data);
+        }
+        g_mutex_unlock(&shard->mutex);
+    }
+}
+
+void
+aztec_cache_get_stats(
+    AztecCacheStats* stats) /* Since 1.0.10 */
+{
+    guint i;
+
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < AZTEC_CACHE_SHARDS; i++) {
+        AztecCacheShard* shard = aztec_cache_shards + i;
+
+        g_mutex_lock(&shard->mutex);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->evictions += shard->evictions;
+        stats->bytes += shard->bytes;
+        stats->count += shard->lru.length;
+        g_mutex_unlock(&shard->mutex);
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef AZTEC_CACHE_H
+#define AZTEC_CACHE_H
+
+#include "aztec_encode.h"
+
+typedef struct aztec_cache_key {
+    const guint8* data;
+    gsize len;
+    guint correction;
+    guint flags;
+    guint layout; /* Layout constraints packed into one word */
+    guint hash;
+} AztecCacheKey;
+
+gboolean
+aztec_cache_enabled(
+    void)
+    G_GNUC_INTERNAL;
+
+void
+aztec_cache_key_init(
+    AztecCacheKey* key,
+    const void* data,
+    gsize len,
+    const AztecEncodeOptions* opts)
+    G_GNUC_INTERNAL;
+
+/* Returns a new reference or NULL */
+AztecSymbol*
+aztec_cache_lookup(
+    const AztecCacheKey* key)
+    G_GNUC_INTERNAL;
+
+/* Adds its own reference to the symbol */
+void
+aztec_cache_insert(
+    const AztecCacheKey* key,
+    AztecSymbol* symbol)
+    G_GNUC_INTERNAL;
+
+#endif /* AZTEC_CACHE_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
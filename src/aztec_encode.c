@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2020 by Slava Monich <slava@monich.com>
+ * Copyright (C) 2019-2026 by Slava Monich <slava@monich.com>
  *
  * You may use this file under the terms of the BSD license as follows:
  *
@@ -36,7 +36,11 @@
 
 #include "aztec_encode.h"
 #include "aztec_bits.h"
+#include "aztec_cache.h"
+#include "aztec_probes.h"
 #include "aztec_rs.h"
+#include "aztec_stats.h"
+#include "aztec_symbol.h"
 
 #include <glib.h>
 #include <string.h>
@@ -55,6 +59,13 @@
 #define MAX_COMPACT_LAYERS (4)
 #define MAX_FULL_LAYERS    (32)
 
+/* Limited by the size of the mode message fields */
+#define MAX_COMPACT_DATA_CODEWORDS (64)
+#define MAX_FULL_DATA_CODEWORDS    (2048)
+
+#define MIN_CORRECTION AZTEC_CORRECTION_LOW
+#define MAX_CORRECTION AZTEC_CORRECTION_HIGHEST
+
 typedef
 void
 (*AztecSymbolFillRowProc)(
@@ -76,12 +87,6 @@ struct aztec_block {
     guint8 mode;
 };
 
-typedef struct aztec_error_correction {
-    guint percent;
-    guint compact[MAX_COMPACT_LAYERS];
-    guint full[MAX_FULL_LAYERS];
-} AztecErrorCorrection;
-
 typedef struct aztec_symbol_params {
     guint8 size;
     guint8 cwsize;
@@ -587,6 +592,9 @@ aztec_encode_data_bits(
     AztecBuilder builder;
     const guint8* end = data + len;
     const guint8* ptr = data;
+    AZTEC_STATS_DECLARE(stats);
+
+    AZTEC_PROBE1(data_bits_start, len);
 
     /* Caller made sure that len > 0 */
     last_block->data = ptr;
@@ -701,7 +709,16 @@ aztec_encode_data_bits(
             builder.mode = builder.pop_mode;
             builder.pop_mode = 0;
         }
-        aztec_encode_builder_shift_or_latch(&builder, block);
+        AZTEC_STATS_INC(stats, blocks);
+        if (builder.mode != block->mode) {
+            /* Shifts leave the mode to return to in pop_mode */
+            aztec_encode_builder_shift_or_latch(&builder, block);
+            if (builder.pop_mode) {
+                AZTEC_STATS_INC(stats, shifts);
+            } else {
+                AZTEC_STATS_INC(stats, latches);
+            }
+        }
         if (builder.mode == MODE_BINARY) {
             /*
              * Encoding long binary sequence may involve multiple
@@ -712,6 +729,7 @@ aztec_encode_data_bits(
                 builder.mode = builder.pop_mode;
                 aztec_encode_builder_shift_or_latch(&builder, block);
                 aztec_encode_builder_append_binary_data(&builder, block->data);
+                AZTEC_STATS_INC(stats, shifts);
             }
             builder.binary_offset = 0;
         } else if (builder.mode == MODE_PUNCT) {
@@ -782,6 +800,7 @@ aztec_encode_data_bits(
     }
 
     g_slice_free_chain(AztecBlock, first_block, next);
+    AZTEC_PROBE2(data_bits_done, len, builder.bits->count);
     return builder.bits;
 }
 
@@ -795,6 +814,7 @@ aztec_encode_codewords(
     AztecCodewords* codewords = aztec_codewords_sized_new(bits->count / b);
     const guint ones = (1 << (b - 1)) - 1;
 
+    AZTEC_PROBE2(codewords_start, bits->count, b);
     while ((offset + b - 1) <= bits->count) {
         const guint word = aztec_bits_get_inv(bits, offset, b - 1);
         guint nextbit;
@@ -833,9 +853,33 @@ aztec_encode_codewords(
         aztec_codewords_append(codewords, data);
     }
 
+    AZTEC_PROBE3(codewords_done, bits->count, b, codewords->count);
     return codewords;
 }
 
+/* Same as aztec_encode_codewords() but only counts the codewords */
+static
+guint
+aztec_encode_count_codewords(
+    const AztecBits* bits,
+    guint b)
+{
+    guint offset = 0, count = 0;
+    const guint ones = (1 << (b - 1)) - 1;
+
+    while ((offset + b - 1) <= bits->count) {
+        const guint word = aztec_bits_get_inv(bits, offset, b - 1);
+
+        /* Stuffed bit doesn't consume any input */
+        offset += b - 1;
+        if (word && word != ones && offset < bits->count) {
+            offset++;
+        }
+        count++;
+    }
+    return (offset < bits->count) ? (count + 1) : count;
+}
+
 static
 void
 aztec_encode_mode_message(
@@ -933,6 +977,8 @@ aztec_encode_compact_symbol(
     guint k, l;
     int i;
 
+    AZTEC_PROBE4(symbol_start, TRUE, symsize, layers, data->count);
+
     /* Fill the symbol with zeros. Bits are tightly packed! */
     aztec_bits_set(symbol, symsize * symsize, 0, 0);
 
@@ -1050,6 +1096,7 @@ aztec_encode_compact_symbol(
         }
     }
 
+    AZTEC_PROBE4(symbol_done, TRUE, symsize, layers, data->count);
     return symbol;
 }
 
@@ -1102,6 +1149,8 @@ aztec_encode_full_symbol(
     guint8 byte;
     int j;
 
+    AZTEC_PROBE4(symbol_start, FALSE, symsize, layers, data->count);
+
     /* Fill the symbol with zeros. Bits are tightly packed! */
     aztec_bits_set(symbol, symsize * symsize, 0, 0);
 
@@ -1291,48 +1340,35 @@ aztec_encode_full_symbol(
     }
 
     g_byte_array_unref(grid);
+    AZTEC_PROBE4(symbol_done, FALSE, symsize, layers, data->count);
     return symbol;
 }
 
+/*
+ * Data capacity of the symbol in bits. The spec recommends 23% of the
+ * symbol capacity plus 3 codewords for error correction, the same rule
+ * is applied to any other percentage. The number of data codewords is
+ * also limited by what the mode message can hold.
+ */
+static
+guint
+aztec_encode_capacity(
+    const AztecSymbolParams* symbol,
+    guint percent,
+    guint max_data_codewords)
+{
+    const guint ecc = symbol->cwcount * percent / 100 + 3;
+
+    return MIN(symbol->cwcount - ecc, max_data_codewords) * symbol->cwsize;
+}
+
 static
 gboolean
 aztec_encode_pick_config(
     guint bitcount,
-    guint correction,
+    const AztecEncodeOptions* opts,
     AztecConfig* config)
 {
-    static const AztecErrorCorrection all_errcor[] = {
-        {
-            10,
-            { 78, 198, 336, 520 },
-            { 96, 246, 408, 616, 840, 1104, 1392, 1704, 2040, 2420,
-              2820, 3250, 3720, 4200, 4730, 5270, 5840, 6450, 7080, 7750,
-              8430, 9150, 9900, 10680, 11484, 12324, 13188, 14076, 15000, 15948,
-              16920, 17940 }
-        },{
-            23,
-            { 66, 168, 288, 440 },
-            { 84, 204, 352, 520, 720, 944, 1184, 1456, 1750, 2070,
-              2410, 2780, 3180, 3590, 4040, 4500, 5000, 5520, 6060, 6630,
-              7210, 7830, 8472, 9132, 9816, 10536, 11280, 12036, 12828, 13644,
-              14472, 15348 }
-        },{
-            36,
-            { 48, 138, 232, 360 },
-            { 66, 168, 288, 432, 592, 776, 984, 1208, 1450, 1720,
-              2000, 2300, 2640, 2980, 3350, 3740, 4150, 4580, 5030, 5500,
-              5990, 6500, 7032, 7584, 8160, 8760, 9372, 9996, 10656, 11340,
-              12024, 12744 }
-        },{
-            50,
-            { 36, 102, 176, 280 },
-            { 48, 126, 216, 328, 456, 600, 760, 936, 1120, 1330,
-              1550, 1790, 2050, 2320, 2610, 2910, 3230, 3570, 3920, 4290,
-              4670, 5070, 5484, 5916, 6360, 6828, 7308, 7800, 8316, 8844,
-              9384, 9948 }
-        }
-    };
-
     /* Symbol paramters (Table 1) */
     static const AztecSymbolParams compact_symbols[MAX_COMPACT_LAYERS] = {
         { 15, 6, 17 }, { 19, 6, 40 },
@@ -1357,21 +1393,23 @@ aztec_encode_pick_config(
         { 147, 12, 1570 }, { 151, 12, 1664 }
     };
 
-    const AztecErrorCorrection* errcor;
     const AztecSymbolParams* symbol = NULL;
+    const guint min_layers = MAX(opts->min_layers, 1);
+    const guint max_layers = opts->max_layers ? opts->max_layers :
+        MAX_FULL_LAYERS;
+    const guint percent = CLAMP(opts->correction, MIN_CORRECTION,
+        MAX_CORRECTION);
     guint i;
+    AZTEC_STATS_DECLARE(stats);
 
-    /* Pick error correction setup */
-    for (i = 0; i < G_N_ELEMENTS(all_errcor); i++) {
-        errcor = all_errcor + i;
-        if (correction <= errcor->percent) {
-            break;
-        }
-    }
-
+    AZTEC_STATS_INC(stats, config_picks);
     memset(config, 0, sizeof(*config));
-    for (i = 0; i < G_N_ELEMENTS(errcor->compact); i++) {
-        if (bitcount <= errcor->compact[i]) {
+    for (i = min_layers - 1;
+         i < MIN(max_layers, G_N_ELEMENTS(compact_symbols)) &&
+         opts->layout != AZTEC_LAYOUT_FULL; i++) {
+        AZTEC_STATS_INC(stats, config_iterations);
+        if (bitcount <= aztec_encode_capacity(compact_symbols + i, percent,
+            MAX_COMPACT_DATA_CODEWORDS)) {
             symbol = compact_symbols + i;
             config->layers = i + 1;
             config->compact = TRUE;
@@ -1381,9 +1419,12 @@ aztec_encode_pick_config(
         }
     }
 
-    if (!symbol) {
-        for (i = 0; i < G_N_ELEMENTS(errcor->full); i++) {
-            if (bitcount <= errcor->full[i]) {
+    if (!symbol && opts->layout != AZTEC_LAYOUT_COMPACT) {
+        for (i = min_layers - 1;
+             i < MIN(max_layers, G_N_ELEMENTS(full_symbols)); i++) {
+            AZTEC_STATS_INC(stats, config_iterations);
+            if (bitcount <= aztec_encode_capacity(full_symbols + i, percent,
+                MAX_FULL_DATA_CODEWORDS)) {
                 symbol = full_symbols + i;
                 config->layers = i + 1;
                 config->encode_mode_message = aztec_encode_full_mode_message;
@@ -1411,6 +1452,32 @@ aztec_encode_pick_config(
     }
 }
 
+/*
+ * Picks the configuration for the next bit stuffing iteration. Returns
+ * FALSE if the data doesn't fit (config is zeroed) or the configuration
+ * has settled down. Never goes back to a smaller symbol, otherwise we
+ * could be bouncing between two configurations forever (the smaller
+ * codeword size may require more stuffing than the larger one).
+ */
+static
+gboolean
+aztec_encode_next_config(
+    guint bitcount,
+    const AztecEncodeOptions* opts,
+    AztecConfig* config,
+    const AztecConfig* prev)
+{
+    if (aztec_encode_pick_config(bitcount, opts, config)) {
+        if (prev->layers && ((config->compact && !prev->compact) ||
+            (config->compact == prev->compact &&
+             config->layers < prev->layers))) {
+            *config = *prev;
+        }
+        return memcmp(config, prev, sizeof(*config)) != 0;
+    }
+    return FALSE;
+}
+
 static
 void
 aztec_encode_symbol_fill_row(
@@ -1453,56 +1520,50 @@ AztecSymbol*
 aztec_encode_symbol_new(
     guint symsize,
     AztecBits* bits,
-    AztecSymbolFillRowProc fill)
+    guint flags)
 {
-    const gsize rowsize = (symsize + 7) / 8;
-    AztecSymbol* symbol = g_malloc(sizeof(AztecSymbol) +
-        symsize * (sizeof(AztecSymbolRow) + rowsize));
-    AztecSymbolRow* rows = (AztecSymbolRow*)(symbol + 1);
-    guint8* data = (guint8*)(rows + symsize);
-    guint y, i = 0;
-
-    symbol->size = symsize;
-    symbol->rows = rows;
-    for (y = 0, i = 0; y < symsize; y++, i += symsize) {
-        guint8* row = data + (y * rowsize);
+    AztecSymbol* symbol = aztec_symbol_alloc(symsize, flags);
+    AztecSymbolFillRowProc fill = (flags & AZTEC_ENCODE_INV) ?
+        aztec_encode_symbol_fill_row_inv :
+        aztec_encode_symbol_fill_row;
+    guint y, i;
 
-        fill(row, symsize, bits, i);
-        rows[y] = row;
+    for (y = 0, i = 0; y < symsize; y++, i += symsize) {
+        fill((guint8*)symbol->rows[y], symsize, bits, i);
     }
     return symbol;
 }
 
-void
-aztec_symbol_free(
-    AztecSymbol* symbol)
-{
-    g_free(symbol);
-}
-
 static
 AztecSymbol*
 aztec_encode_full(
     const void* data,
     gsize len,
-    guint correction,
-    AztecSymbolFillRowProc fill)
+    const AztecEncodeOptions* opts)
 {
     AztecConfig config, config1;
     AztecCodewords* cw = NULL;
-    AztecBits* bits = len ? aztec_encode_data_bits(data, len) :
-        aztec_bits_new();
-    guint bitcount = bits->count;
+    AztecBits* bits;
+    guint bitcount;
     AztecSymbol* symbol = NULL;
+    AZTEC_STATS_DECLARE(stats);
+    AZTEC_STATS_TIMER(timer);
 
+    AZTEC_PROBE2(encode_start, len, opts->correction);
+    bits = len ? aztec_encode_data_bits(data, len) : aztec_bits_new();
+    bitcount = bits->count;
+    AZTEC_STATS_LAP(stats, AZTEC_STAGE_SEGMENT, timer);
     memset(&config1, 0, sizeof(config1));
-    while (aztec_encode_pick_config(bitcount, correction, &config) &&
-        memcmp(&config, &config1, sizeof(config))) {
+    while (aztec_encode_next_config(bitcount, opts, &config, &config1)) {
+        AZTEC_STATS_LAP(stats, AZTEC_STAGE_CONFIG, timer);
         aztec_codewords_free(cw, TRUE);
         cw = aztec_encode_codewords(bits, config.cwsize);
         bitcount = cw->count * config.cwsize;
         config1 = config;
+        AZTEC_STATS_INC(stats, stuffing_rounds);
+        AZTEC_STATS_LAP(stats, AZTEC_STAGE_STUFF, timer);
     }
+    AZTEC_STATS_LAP(stats, AZTEC_STAGE_CONFIG, timer);
 
     if (config.layers) {
         const guint data_blocks = cw->count;
@@ -1511,9 +1572,15 @@ aztec_encode_full(
         AztecBits* symbol_bits;
         guint i;
 
+        AZTEC_STATS_INC(stats, encodes);
+        AZTEC_STATS_ADD(stats, bytes, len);
+        AZTEC_STATS_ADD(stats, stuffed_bits, bitcount - bits->count);
+        AZTEC_STATS_ADD(stats, codewords, config.cwcount);
+
         aztec_codewords_set_count(cw, config.cwcount);
         aztec_rs_encode16_full(config.gfpoly, 1, cw->words, data_blocks,
             cw->words + data_blocks, ecc_blocks);
+        AZTEC_STATS_LAP(stats, AZTEC_STAGE_RS, timer);
 
         /* Repack codewords into a bitstream, most significant bit first */
         aztec_bits_clear(bits);
@@ -1524,26 +1591,166 @@ aztec_encode_full(
 
         /* Generate the symbol */
         mode_bits = config.encode_mode_message(config.layers, data_blocks);
+        AZTEC_STATS_LAP(stats, AZTEC_STAGE_MODE, timer);
         symbol_bits = config.encode_symbol(config.symsize, bits, mode_bits);
         aztec_bits_free(mode_bits);
+        AZTEC_STATS_LAP(stats, AZTEC_STAGE_PLACE, timer);
 
         /* Convert the symbol into export format */
-        symbol = aztec_encode_symbol_new(config.symsize, symbol_bits, fill);
+        symbol = aztec_encode_symbol_new(config.symsize, symbol_bits,
+            opts->flags & AZTEC_ENCODE_INV);
         aztec_bits_free(symbol_bits);
+        AZTEC_STATS_LAP(stats, AZTEC_STAGE_EXPORT, timer);
     }
+    AZTEC_PROBE5(encode_done, len, bitcount, config.layers, config.cwsize,
+        config.symsize);
     aztec_codewords_free(cw, TRUE);
     aztec_bits_free(bits);
     return symbol;
 }
 
+/*
+ * Rejects the constraints which can't be satisfied and drops the layer
+ * limit which doesn't limit anything, so that equivalent options look
+ * the same (e.g. to the cache).
+ */
+static
+gboolean
+aztec_encode_options_check(
+    const AztecEncodeOptions* in,
+    AztecEncodeOptions* out)
+{
+    if (in->layout > AZTEC_LAYOUT_FULL ||
+        in->min_layers > MAX_FULL_LAYERS ||
+        (in->max_layers && in->min_layers > in->max_layers)) {
+        return FALSE;
+    } else {
+        *out = *in;
+        if (in->max_layers >= MAX_FULL_LAYERS) {
+            out->max_layers = 0;
+        }
+        return TRUE;
+    }
+}
+
+static
+void
+aztec_encode_options_init(
+    AztecEncodeOptions* opts,
+    guint correction,
+    guint flags)
+{
+    memset(opts, 0, sizeof(*opts));
+    opts->correction = correction;
+    opts->flags = flags;
+}
+
+gboolean
+aztec_encode_measure_with_options(
+    const void* data,
+    gsize len,
+    const AztecEncodeOptions* options,
+    AztecEncodeInfo* info) /* Since 1.0.10 */
+{
+    AztecEncodeOptions checked;
+    const AztecEncodeOptions* opts = &checked;
+    AztecConfig config, config1;
+    AztecBits* bits;
+    guint bitcount;
+    guint cwcount = 0;
+
+    if (!options) {
+        aztec_encode_options_init(&checked, AZTEC_CORRECTION_DEFAULT, 0);
+    } else if (!aztec_encode_options_check(options, &checked)) {
+        if (info) {
+            memset(info, 0, sizeof(*info));
+        }
+        return FALSE;
+    }
+
+    bits = len ? aztec_encode_data_bits(data, len) : aztec_bits_new();
+    bitcount = bits->count;
+
+    /* Same loop as in aztec_encode_full() minus the allocations */
+    memset(&config1, 0, sizeof(config1));
+    while (aztec_encode_next_config(bitcount, opts, &config, &config1)) {
+        cwcount = aztec_encode_count_codewords(bits, config.cwsize);
+        bitcount = cwcount * config.cwsize;
+        config1 = config;
+    }
+
+    if (info) {
+        memset(info, 0, sizeof(*info));
+        info->bits = bits->count;
+        if (config.layers) {
+            info->compact = config.compact;
+            info->layers = config.layers;
+            info->size = config.symsize;
+            info->cwsize = config.cwsize;
+            info->cwcount = config.cwcount;
+            info->data_cwcount = cwcount;
+        }
+    }
+    aztec_bits_free(bits);
+    return config.layers != 0;
+}
+
+gboolean
+aztec_encode_measure(
+    const void* data,
+    gsize len,
+    guint correction,
+    AztecEncodeInfo* info) /* Since 1.0.10 */
+{
+    AztecEncodeOptions opts;
+
+    aztec_encode_options_init(&opts, correction, 0);
+    return aztec_encode_measure_with_options(data, len, &opts, info);
+}
+
+AztecSymbol*
+aztec_encode_with_options(
+    const void* data,
+    gsize len,
+    const AztecEncodeOptions* options) /* Since 1.0.10 */
+{
+    AztecEncodeOptions checked;
+    const AztecEncodeOptions* opts = &checked;
+
+    if (!options) {
+        aztec_encode_options_init(&checked, AZTEC_CORRECTION_DEFAULT, 0);
+    } else if (!aztec_encode_options_check(options, &checked)) {
+        return NULL;
+    }
+
+    if (aztec_cache_enabled()) {
+        AztecCacheKey key;
+        AztecSymbol* symbol;
+
+        aztec_cache_key_init(&key, data, len, opts);
+        symbol = aztec_cache_lookup(&key);
+        if (!symbol) {
+            symbol = aztec_encode_full(data, len, opts);
+            if (symbol) {
+                aztec_cache_insert(&key, symbol);
+            }
+        }
+        return symbol;
+    } else {
+        return aztec_encode_full(data, len, opts);
+    }
+}
+
 AztecSymbol*
 aztec_encode(
     const void* data,
     gsize len,
     guint correction)
 {
-    return aztec_encode_full(data, len, correction,
-        aztec_encode_symbol_fill_row);
+    AztecEncodeOptions opts;
+
+    aztec_encode_options_init(&opts, correction, 0);
+    return aztec_encode_with_options(data, len, &opts);
 }
 
 AztecSymbol*
@@ -1552,8 +1759,10 @@ aztec_encode_inv(
     gsize len,
     guint correction) /* Since 1.0.2 */
 {
-    return aztec_encode_full(data, len, correction,
-        aztec_encode_symbol_fill_row_inv);
+    AztecEncodeOptions opts;
+
+    aztec_encode_options_init(&opts, correction, AZTEC_ENCODE_INV);
+    return aztec_encode_with_options(data, len, &opts);
 }
 
 /*
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_encode_async.h"
+
+typedef struct aztec_encode_async_data {
+    GBytes* bytes;
+    guint correct;
+    guint flags;
+} AztecEncodeAsyncData;
+
+G_DEFINE_QUARK(aztec-encode-error-quark, aztec_encode_error)
+
+static
+void
+aztec_encode_async_data_free(
+    gpointer data)
+{
+    AztecEncodeAsyncData* async = data;
+
+    g_bytes_unref(async->bytes);
+    g_slice_free1(sizeof(*async), async);
+}
+
+static
+void
+aztec_encode_async_thread(
+    GTask* task,
+    gpointer source,
+    gpointer data,
+    GCancellable* cancellable)
+{
+    if (!g_task_return_error_if_cancelled(task)) {
+        AztecEncodeAsyncData* async = data;
+        gsize len;
+        const void* bytes = g_bytes_get_data(async->bytes, &len);
+        AztecSymbol* symbol = (async->flags & AZTEC_ENCODE_INV) ?
+            aztec_encode_inv(bytes, len, async->correct) :
+            aztec_encode(bytes, len, async->correct);
+
+        /*
+         * If the task has been cancelled in the meantime, the result
+         * has already been delivered and nobody needs the symbol.
+         */
+        if (g_task_set_return_on_cancel(task, FALSE)) {
+            if (symbol) {
+                g_task_return_pointer(task, symbol, (GDestroyNotify)
+                    aztec_symbol_free);
+            } else {
+                g_task_return_new_error(task, AZTEC_ENCODE_ERROR,
+                    AZTEC_ENCODE_ERROR_TOO_MUCH_DATA,
+                    "Failed to encode %u bytes", (guint)len);
+            }
+        } else {
+            aztec_symbol_free(symbol);
+        }
+    }
+}
+
+void
+aztec_encode_async(
+    const void* data,
+    gsize len,
+    guint correct,
+    guint flags,
+    GCancellable* cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data) /* Since 1.0.10 */
+{
+    GTask* task = g_task_new(NULL, cancellable, callback, user_data);
+    AztecEncodeAsyncData* async = g_slice_new(AztecEncodeAsyncData);
+
+    async->bytes = g_bytes_new(data, len);
+    async->correct = correct;
+    async->flags = flags;
+    g_task_set_source_tag(task, aztec_encode_async);
+    g_task_set_task_data(task, async, aztec_encode_async_data_free);
+    g_task_set_return_on_cancel(task, TRUE);
+    g_task_run_in_thread(task, aztec_encode_async_thread);
+    g_object_unref(task);
+}
+
+AztecSymbol*
+aztec_encode_finish(
+    GAsyncResult* result,
+    GError** error) /* Since 1.0.10 */
+{
+    g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
+    g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) ==
+        aztec_encode_async, NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
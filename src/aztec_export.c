@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_render.h"
+#include "aztec_symbol.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+static
+inline
+guint
+aztec_export_module(
+    const guint8* row,
+    guint x,
+    gboolean inv)
+{
+    return inv ?
+        ((row[x >> 3] >> (7 - (x & 7))) & 1) :
+        ((row[x >> 3] >> (x & 7)) & 1);
+}
+
+static
+void
+aztec_export_row_mono(
+    const guint8* src,
+    guint size,
+    gboolean reverse,
+    guint8* dest)
+{
+    const guint n = (size + 7) / 8;
+
+    if (reverse) {
+        guint i;
+
+        for (i = 0; i < n; i++) {
+            dest[i] = aztec_symbol_reverse_bits(src[i]);
+        }
+    } else {
+        memcpy(dest, src, n);
+    }
+}
+
+static
+void
+aztec_export_row_gray8(
+    const guint8* src,
+    guint size,
+    gboolean inv,
+    guint8 dark,
+    guint8 light,
+    guint8* dest)
+{
+    guint x = 0;
+
+#ifdef __SSE2__
+    /* 16 pixels per iteration, each lane picks its own bit */
+    const __m128i vdark = _mm_set1_epi8(dark);
+    const __m128i vlight = _mm_set1_epi8(light);
+    const __m128i mask = inv ?
+        _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1,
+            -128, 64, 32, 16, 8, 4, 2, 1) :
+        _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+            1, 2, 4, 8, 16, 32, 64, -128);
+
+    for (; x + 16 <= size; x += 16) {
+        const guint8* ptr = src + x / 8;
+        __m128i v = _mm_cvtsi32_si128(ptr[0] | (ptr[1] << 8));
+        __m128i m;
+
+        /* Broadcast the first byte to lanes 0-7, the second to 8-15 */
+        v = _mm_unpacklo_epi8(v, v);
+        v = _mm_unpacklo_epi16(v, v);
+        v = _mm_unpacklo_epi32(v, v);
+        m = _mm_cmpeq_epi8(_mm_and_si128(v, mask), mask);
+        _mm_storeu_si128((__m128i*)(dest + x), _mm_or_si128(
+            _mm_and_si128(m, vdark), _mm_andnot_si128(m, vlight)));
+    }
+#endif
+
+    for (; x < size; x++) {
+        dest[x] = aztec_export_module(src, x, inv) ? dark : light;
+    }
+}
+
+static
+void
+aztec_export_row_32(
+    const guint8* src,
+    guint size,
+    gboolean inv,
+    guint32 dark,
+    guint32 light,
+    guint32* dest)
+{
+    guint x = 0;
+
+#ifdef __SSE2__
+    /* 8 pixels (one source byte) per iteration */
+    const __m128i vdark = _mm_set1_epi32(dark);
+    const __m128i vlight = _mm_set1_epi32(light);
+    const __m128i mask1 = inv ?
+        _mm_setr_epi32(0x80, 0x40, 0x20, 0x10) :
+        _mm_setr_epi32(0x01, 0x02, 0x04, 0x08);
+    const __m128i mask2 = inv ?
+        _mm_setr_epi32(0x08, 0x04, 0x02, 0x01) :
+        _mm_setr_epi32(0x10, 0x20, 0x40, 0x80);
+
+    for (; x + 8 <= size; x += 8) {
+        const __m128i v = _mm_set1_epi32(src[x / 8]);
+        const __m128i m1 = _mm_cmpeq_epi32(_mm_and_si128(v, mask1), mask1);
+        const __m128i m2 = _mm_cmpeq_epi32(_mm_and_si128(v, mask2), mask2);
+
+        _mm_storeu_si128((__m128i*)(dest + x), _mm_or_si128(
+            _mm_and_si128(m1, vdark), _mm_andnot_si128(m1, vlight)));
+        _mm_storeu_si128((__m128i*)(dest + x + 4), _mm_or_si128(
+            _mm_and_si128(m2, vdark), _mm_andnot_si128(m2, vlight)));
+    }
+#endif
+
+    for (; x < size; x++) {
+        dest[x] = aztec_export_module(src, x, inv) ? dark : light;
+    }
+}
+
+static
+inline
+guint32
+aztec_export_rgba(
+    guint32 argb)
+{
+    /* R, G, B, A in memory */
+    return GUINT32_FROM_BE((argb << 8) | (argb >> 24));
+}
+
+gboolean
+aztec_symbol_export(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    guint32 dark,
+    guint32 light,
+    void* pixels,
+    gsize stride) /* Since 1.0.10 */
+{
+    if (symbol && pixels) {
+        const guint size = symbol->size;
+        const gboolean inv = (aztec_symbol_flags(symbol) &
+            AZTEC_ENCODE_INV) != 0;
+        guint8* dest = pixels;
+        guint y;
+
+        switch (format) {
+        case AZTEC_PIXEL_MONO_LSB:
+        case AZTEC_PIXEL_MONO_MSB:
+            if (stride >= (size + 7) / 8) {
+                const gboolean msb = (format == AZTEC_PIXEL_MONO_MSB);
+
+                for (y = 0; y < size; y++, dest += stride) {
+                    aztec_export_row_mono(symbol->rows[y], size, inv != msb,
+                        dest);
+                }
+                return TRUE;
+            }
+            break;
+        case AZTEC_PIXEL_GRAY8:
+            if (stride >= size) {
+                for (y = 0; y < size; y++, dest += stride) {
+                    aztec_export_row_gray8(symbol->rows[y], size, inv,
+                        (guint8)dark, (guint8)light, dest);
+                }
+                return TRUE;
+            }
+            break;
+        case AZTEC_PIXEL_ARGB32:
+        case AZTEC_PIXEL_RGBA32:
+            if (stride >= size * 4) {
+                if (format == AZTEC_PIXEL_RGBA32) {
+                    dark = aztec_export_rgba(dark);
+                    light = aztec_export_rgba(light);
+                }
+                for (y = 0; y < size; y++, dest += stride) {
+                    aztec_export_row_32(symbol->rows[y], size, inv,
+                        dark, light, (guint32*)dest);
+                }
+                return TRUE;
+            }
+            break;
+        }
+    }
+    return FALSE;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
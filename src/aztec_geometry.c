@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_render.h"
+#include "aztec_symbol.h"
+
+/*
+ * Appends the runs of dark modules found in the row y, returns the
+ * number of runs added. Whole light and whole dark bytes are skipped
+ * in one step.
+ */
+static
+guint
+aztec_geometry_row_runs(
+    const AztecSymbol* symbol,
+    guint y,
+    gboolean inv,
+    GArray* out)
+{
+    const guint8* row = symbol->rows[y];
+    const guint size = symbol->size;
+    const guint n = out->len;
+    AztecRect run;
+    gboolean dark = FALSE;
+    guint x = 0;
+
+    run.y = y;
+    run.height = 1;
+    run.x = run.width = 0;
+    while (x < size) {
+        const guint8 byte = inv ? aztec_symbol_reverse_bits(row[x / 8]) :
+            row[x / 8];
+
+        if (!(x % 8) && byte == (dark ? 0xff : 0x00) && (x + 8) <= size) {
+            /* Nothing changes within this byte */
+            x += 8;
+        } else {
+            const gboolean bit = (byte >> (x % 8)) & 1;
+
+            if (bit != dark) {
+                if (dark) {
+                    run.width = x - run.x;
+                    g_array_append_val(out, run);
+                } else {
+                    run.x = x;
+                }
+                dark = bit;
+            }
+            x++;
+        }
+    }
+    if (dark) {
+        run.width = size - run.x;
+        g_array_append_val(out, run);
+    }
+    return out->len - n;
+}
+
+AztecRect*
+aztec_symbol_runs(
+    const AztecSymbol* symbol,
+    guint* count) /* Since 1.0.10 */
+{
+    guint n = 0;
+    AztecRect* runs = NULL;
+
+    if (symbol) {
+        const gboolean inv = (aztec_symbol_flags(symbol) &
+            AZTEC_ENCODE_INV) != 0;
+        GArray* out = g_array_sized_new(FALSE, FALSE, sizeof(AztecRect),
+            symbol->size * 8);
+        guint y;
+
+        for (y = 0; y < symbol->size; y++) {
+            aztec_geometry_row_runs(symbol, y, inv, out);
+        }
+        n = out->len;
+        runs = (AztecRect*)g_array_free(out, FALSE);
+    }
+    if (count) {
+        *count = n;
+    }
+    return runs;
+}
+
+AztecRect*
+aztec_symbol_rects(
+    const AztecSymbol* symbol,
+    guint* count) /* Since 1.0.10 */
+{
+    guint n = 0;
+    AztecRect* rects = NULL;
+
+    if (symbol) {
+        const gboolean inv = (aztec_symbol_flags(symbol) &
+            AZTEC_ENCODE_INV) != 0;
+        GArray* out = g_array_sized_new(FALSE, FALSE, sizeof(AztecRect),
+            symbol->size * 4);
+        GArray* runs = g_array_sized_new(FALSE, FALSE, sizeof(AztecRect),
+            symbol->size);
+        /* Indices of the rectangles which reach the previous row */
+        GArray* open = g_array_sized_new(FALSE, FALSE, sizeof(guint),
+            symbol->size);
+        GArray* next = g_array_sized_new(FALSE, FALSE, sizeof(guint),
+            symbol->size);
+        guint y;
+
+        for (y = 0; y < symbol->size; y++) {
+            const guint* prev = (guint*)open->data;
+            guint i, k = 0;
+            GArray* tmp;
+
+            g_array_set_size(runs, 0);
+            g_array_set_size(next, 0);
+            aztec_geometry_row_runs(symbol, y, inv, runs);
+
+            /* Both lists are sorted by x */
+            for (i = 0; i < runs->len; i++) {
+                const AztecRect* run = &g_array_index(runs, AztecRect, i);
+                guint index;
+
+                while (k < open->len &&
+                    g_array_index(out, AztecRect, prev[k]).x < run->x) {
+                    k++;
+                }
+                if (k < open->len &&
+                    g_array_index(out, AztecRect, prev[k]).x == run->x &&
+                    g_array_index(out, AztecRect, prev[k]).width ==
+                    run->width) {
+                    /* Extend the rectangle down */
+                    index = prev[k++];
+                    g_array_index(out, AztecRect, index).height++;
+                } else {
+                    index = out->len;
+                    g_array_append_val(out, *run);
+                }
+                g_array_append_val(next, index);
+            }
+
+            /* Swap the lists */
+            tmp = open;
+            open = next;
+            next = tmp;
+        }
+
+        g_array_free(runs, TRUE);
+        g_array_free(open, TRUE);
+        g_array_free(next, TRUE);
+        n = out->len;
+        rects = (AztecRect*)g_array_free(out, FALSE);
+    }
+    if (count) {
+        *count = n;
+    }
+    return rects;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
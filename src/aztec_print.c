@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_print.h"
+#include "aztec_render.h"
+
+#include <gio/gio.h>
+
+#include <string.h>
+
+static const char aztec_print_hex[] = "0123456789ABCDEF";
+
+static
+void
+aztec_print_append_hex(
+    GString* out,
+    const guint8* row,
+    gsize rowsize)
+{
+    gsize i;
+
+    for (i = 0; i < rowsize; i++) {
+        g_string_append_c(out, aztec_print_hex[row[i] >> 4]);
+        g_string_append_c(out, aztec_print_hex[row[i] & 0x0f]);
+    }
+}
+
+/*
+ * ZPL repeat counts: G..Y stand for 1..19, g..z for 20..400 in steps
+ * of 20, and are added together.
+ */
+static
+void
+aztec_print_append_acs_run(
+    GString* out,
+    char c,
+    guint n)
+{
+    if (n > 1) {
+        while (n >= 20) {
+            const guint k = MIN(n / 20, 20);
+
+            g_string_append_c(out, 'g' + (k - 1));
+            n -= k * 20;
+        }
+        if (n) {
+            g_string_append_c(out, 'G' + (n - 1));
+        }
+    }
+    g_string_append_c(out, c);
+}
+
+static
+void
+aztec_print_append_acs(
+    GString* out,
+    const guint8* row,
+    gsize rowsize)
+{
+    const gsize len = rowsize * 2;
+    char* hex = g_malloc(len);
+    gsize i, end = len;
+
+    for (i = 0; i < rowsize; i++) {
+        hex[2 * i] = aztec_print_hex[row[i] >> 4];
+        hex[2 * i + 1] = aztec_print_hex[row[i] & 0x0f];
+    }
+
+    /* ',' fills the rest of the row with zeros, '!' with ones */
+    while (end > 0 && hex[end - 1] == hex[len - 1]) end--;
+    if (len - end < 2 || (hex[len - 1] != '0' && hex[len - 1] != 'F')) {
+        end = len;
+    }
+
+    for (i = 0; i < end;) {
+        const char c = hex[i];
+        gsize n = 1;
+
+        while (i + n < end && hex[i + n] == c) n++;
+        aztec_print_append_acs_run(out, c, n);
+        i += n;
+    }
+    if (end < len) {
+        g_string_append_c(out, (hex[len - 1] == '0') ? ',' : '!');
+    }
+    g_free(hex);
+}
+
+static
+GByteArray*
+aztec_print_deflate(
+    const guint8* data,
+    gsize len)
+{
+    GConverter* zlib = G_CONVERTER(g_zlib_compressor_new
+        (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, -1));
+    GByteArray* out = g_byte_array_sized_new(len / 4 + 64);
+    GConverterResult result;
+
+    do {
+        const guint pos = out->len;
+        const gsize avail = MAX(len, 64);
+        gsize nread = 0, nwritten = 0;
+
+        g_byte_array_set_size(out, pos + avail);
+        result = g_converter_convert(zlib, data, len, out->data + pos, avail,
+            G_CONVERTER_INPUT_AT_END, &nread, &nwritten, NULL);
+        g_byte_array_set_size(out, pos + nwritten);
+        data += nread;
+        len -= nread;
+    } while (result == G_CONVERTER_CONVERTED);
+
+    g_object_unref(zlib);
+    if (result == G_CONVERTER_FINISHED) {
+        return out;
+    } else {
+        g_byte_array_unref(out);
+        return NULL;
+    }
+}
+
+/* CRC-16-CCITT (polynomial 0x1021, zero initial value) */
+static
+guint16
+aztec_print_crc16(
+    const char* data,
+    gsize len)
+{
+    guint16 crc = 0;
+    gsize i;
+
+    for (i = 0; i < len; i++) {
+        int k;
+
+        crc ^= ((guint8)data[i]) << 8;
+        for (k = 0; k < 8; k++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static
+gboolean
+aztec_print_append_z64(
+    GString* out,
+    const guint8* data,
+    gsize len)
+{
+    GByteArray* zipped = aztec_print_deflate(data, len);
+
+    if (zipped) {
+        char* b64 = g_base64_encode(zipped->data, zipped->len);
+        const gsize b64len = strlen(b64);
+
+        g_string_append(out, ":Z64:");
+        g_string_append_len(out, b64, b64len);
+        g_string_append_printf(out, ":%04x", aztec_print_crc16(b64, b64len));
+        g_byte_array_unref(zipped);
+        g_free(b64);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+char*
+aztec_symbol_zpl(
+    const AztecSymbol* symbol,
+    AztecZplFormat format,
+    guint scale,
+    guint border) /* Since 1.0.10 */
+{
+    AztecRowReader* reader = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, scale, border);
+
+    if (reader) {
+        const guint height = aztec_row_reader_height(reader);
+        const gsize rowsize = aztec_row_reader_rowsize(reader);
+        const gsize total = rowsize * height;
+        GString* out = g_string_sized_new(32 + ((format == AZTEC_ZPL_HEX) ?
+            (2 * total) : (total / 2)));
+        GByteArray* bin = NULL;
+        gboolean ok = TRUE;
+        const guint8* row;
+        guint repeat, i;
+
+        g_string_append_printf(out, "^GFA,%lu,%lu,%lu,", (gulong) total,
+            (gulong) total, (gulong) rowsize);
+        if (format == AZTEC_ZPL_Z64) {
+            bin = g_byte_array_sized_new(total);
+        }
+
+        while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+            switch (format) {
+            case AZTEC_ZPL_HEX:
+                for (i = 0; i < repeat; i++) {
+                    aztec_print_append_hex(out, row, rowsize);
+                }
+                break;
+            case AZTEC_ZPL_ACS:
+                /* ':' repeats the previous row */
+                aztec_print_append_acs(out, row, rowsize);
+                for (i = 1; i < repeat; i++) {
+                    g_string_append_c(out, ':');
+                }
+                break;
+            case AZTEC_ZPL_Z64:
+                for (i = 0; i < repeat; i++) {
+                    g_byte_array_append(bin, row, rowsize);
+                }
+                break;
+            default:
+                ok = FALSE;
+                break;
+            }
+        }
+
+        if (bin) {
+            ok = aztec_print_append_z64(out, bin->data, bin->len);
+            g_byte_array_unref(bin);
+        }
+        aztec_row_reader_free(reader);
+        return g_string_free(out, !ok);
+    }
+    return NULL;
+}
+
+GBytes*
+aztec_symbol_escpos(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border,
+    guint max_rows) /* Since 1.0.10 */
+{
+    AztecRowReader* reader = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, scale, border);
+
+    if (reader) {
+        const guint height = aztec_row_reader_height(reader);
+        const gsize rowsize = aztec_row_reader_rowsize(reader);
+        const guint band = (max_rows && max_rows < 0xffff) ? max_rows : 0xffff;
+        GByteArray* out = g_byte_array_sized_new(rowsize * height +
+            8 * (height / band + 1));
+        guint y = 0, left = 0;
+        const guint8* row;
+        guint repeat;
+
+        while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+            while (repeat > 0) {
+                guint n;
+
+                if (!left) {
+                    /* GS v 0 m xL xH yL yH */
+                    guint8 cmd[8];
+
+                    left = MIN(band, height - y);
+                    cmd[0] = 0x1d;
+                    cmd[1] = 'v';
+                    cmd[2] = '0';
+                    cmd[3] = 0;
+                    cmd[4] = (guint8) rowsize;
+                    cmd[5] = (guint8) (rowsize >> 8);
+                    cmd[6] = (guint8) left;
+                    cmd[7] = (guint8) (left >> 8);
+                    g_byte_array_append(out, cmd, sizeof(cmd));
+                }
+
+                n = MIN(repeat, left);
+                y += n;
+                left -= n;
+                repeat -= n;
+                while (n-- > 0) {
+                    g_byte_array_append(out, row, rowsize);
+                }
+            }
+        }
+        aztec_row_reader_free(reader);
+        return g_byte_array_free_to_bytes(out);
+    }
+    return NULL;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
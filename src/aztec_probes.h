@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef AZTEC_PROBES_H
+#define AZTEC_PROBES_H
+
+/*
+ * USDT (statically defined tracing) probes, compiled in if AZTEC_USDT
+ * is defined (make AZTEC_USDT=1, requires <sys/sdt.h> from systemtap).
+ * Each probe is a single nop plus a note describing where to find its
+ * arguments, so the cost is close to zero until a tracer attaches to it.
+ * The provider is libaztec, e.g.
+ *
+ *   bpftrace -e 'usdt:./libaztec.so:libaztec:encode_done
+ *       { @[arg2] = count(); }'
+ */
+#ifdef AZTEC_USDT
+
+#  include <sys/sdt.h>
+
+#  define AZTEC_PROBE1(name,a1) \
+    DTRACE_PROBE1(libaztec, name, a1)
+#  define AZTEC_PROBE2(name,a1,a2) \
+    DTRACE_PROBE2(libaztec, name, a1, a2)
+#  define AZTEC_PROBE3(name,a1,a2,a3) \
+    DTRACE_PROBE3(libaztec, name, a1, a2, a3)
+#  define AZTEC_PROBE4(name,a1,a2,a3,a4) \
+    DTRACE_PROBE4(libaztec, name, a1, a2, a3, a4)
+#  define AZTEC_PROBE5(name,a1,a2,a3,a4,a5) \
+    DTRACE_PROBE5(libaztec, name, a1, a2, a3, a4, a5)
+
+#else
+
+#  define AZTEC_PROBE1(name,a1) ((void)0)
+#  define AZTEC_PROBE2(name,a1,a2) ((void)0)
+#  define AZTEC_PROBE3(name,a1,a2,a3) ((void)0)
+#  define AZTEC_PROBE4(name,a1,a2,a3,a4) ((void)0)
+#  define AZTEC_PROBE5(name,a1,a2,a3,a4,a5) ((void)0)
+
+#endif /* AZTEC_USDT */
+
+#endif /* AZTEC_PROBES_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,529 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_render.h"
+#include "aztec_symbol.h"
+
+#include <string.h>
+
+/*
+ * Scale factors up to 8 are handled with byte expansion tables: each
+ * source byte (8 modules) turns into 8 * scale bits, which fit into a
+ * 64-bit word. Larger scales are rendered module by module, each module
+ * being at least one whole byte anyway.
+ */
+
+#define AZTEC_RENDER_TABLE_MAX_SCALE (8)
+
+typedef struct aztec_render_table {
+    guint64 bits[256];
+} AztecRenderTable;
+
+static AztecRenderTable* aztec_render_tables[AZTEC_RENDER_TABLE_MAX_SCALE];
+
+static
+const AztecRenderTable*
+aztec_render_table(
+    guint scale)
+{
+    AztecRenderTable** table = aztec_render_tables + (scale - 1);
+
+    if (g_once_init_enter(table)) {
+        AztecRenderTable* t = g_new(AztecRenderTable, 1);
+        const guint64 run = (G_GUINT64_CONSTANT(1) << scale) - 1;
+        guint i, k;
+
+        for (i = 0; i < 256; i++) {
+            guint64 bits = 0;
+
+            for (k = 0; k < 8; k++) {
+                if (i & (1 << k)) {
+                    bits |= run << (k * scale);
+                }
+            }
+            t->bits[i] = bits;
+        }
+        g_once_init_leave(table, t);
+    }
+    return *table;
+}
+
+/* ORs nbits bits (LSB first) into the zero-initialized row */
+static
+void
+aztec_render_put_bits(
+    guint8* row,
+    gsize pos,
+    guint64 bits,
+    guint nbits)
+{
+    guint8* ptr = row + pos / 8;
+    const guint shift = pos % 8;
+
+    if (shift) {
+        const guint n = 8 - shift;
+
+        *ptr++ |= (guint8)(bits << shift);
+        if (nbits <= n) {
+            return;
+        }
+        bits >>= n;
+        nbits -= n;
+    }
+    while (nbits >= 8) {
+        *ptr++ = (guint8)bits;
+        bits >>= 8;
+        nbits -= 8;
+    }
+    if (nbits) {
+        *ptr |= (guint8)bits;
+    }
+}
+
+/* Sets nbits bits starting at pos */
+static
+void
+aztec_render_put_run(
+    guint8* row,
+    gsize pos,
+    guint nbits)
+{
+    guint8* ptr = row + pos / 8;
+    const guint shift = pos % 8;
+
+    if (shift) {
+        const guint n = 8 - shift;
+
+        if (nbits <= n) {
+            *ptr |= (guint8)(((1 << nbits) - 1) << shift);
+            return;
+        }
+        *ptr++ |= (guint8)(0xff << shift);
+        nbits -= n;
+    }
+    memset(ptr, 0xff, nbits / 8);
+    ptr += nbits / 8;
+    if (nbits % 8) {
+        *ptr |= (guint8)((1 << (nbits % 8)) - 1);
+    }
+}
+
+/* ORs the scaled source row into the zero-initialized row at bit pos */
+static
+void
+aztec_render_put_row(
+    const guint8* src,
+    guint size,
+    gboolean inv,
+    guint scale,
+    gsize pos,
+    guint8* row)
+{
+    guint x;
+
+    if (scale <= AZTEC_RENDER_TABLE_MAX_SCALE) {
+        const AztecRenderTable* table = aztec_render_table(scale);
+        const guint step = 8 * scale;
+
+        for (x = 0; x < size; x += 8, pos += step) {
+            const guint8 byte = *src++;
+
+            if (byte) {
+                const guint n = MIN(size - x, 8);
+
+                aztec_render_put_bits(row, pos, table->bits[inv ?
+                    aztec_symbol_reverse_bits(byte) : byte], n * scale);
+            }
+        }
+    } else {
+        for (x = 0; x < size; x++, pos += scale) {
+            const guint8 byte = src[x / 8];
+
+            if (inv ? (byte & (0x80 >> (x % 8))) : (byte & (1 << (x % 8)))) {
+                aztec_render_put_run(row, pos, scale);
+            }
+        }
+    }
+}
+
+/*
+ * The reader lays the symbols out on a grid, the single symbol case
+ * being a sheet with one cell. All cells have the same size (in modules,
+ * including the quiet zone), smaller symbols are centered in their cells.
+ * All symbol sizes are odd, so the difference between any two sizes is
+ * even and the symbols stay aligned to the module grid. The image is
+ * produced one module row at a time, each output row being assembled
+ * from the matching rows of all symbols in the band.
+ */
+struct aztec_row_reader {
+    const AztecSymbol** symbols;
+    const AztecSymbol* single;
+    guint count;
+    guint columns;
+    guint cell;
+    guint modules;
+    guint scale;
+    guint border;
+    gboolean msb;
+    guint y;
+    gsize width;
+    gsize height;
+    gsize rowsize;
+    guint8* row;
+};
+
+static
+gboolean
+aztec_row_reader_init(
+    AztecRowReader* reader,
+    const AztecSymbol* const* symbols,
+    guint count,
+    guint columns,
+    AztecPixelFormat format,
+    guint scale,
+    guint border)
+{
+    if (symbols && count && columns && scale &&
+        (format == AZTEC_PIXEL_MONO_LSB || format == AZTEC_PIXEL_MONO_MSB)) {
+        guint i, size = 0;
+
+        for (i = 0; i < count; i++) {
+            if (symbols[i]) {
+                size = MAX(size, symbols[i]->size);
+            }
+        }
+        if (size) {
+            memset(reader, 0, sizeof(*reader));
+            if (count == 1) {
+                reader->single = symbols[0];
+                reader->symbols = &reader->single;
+            } else {
+                reader->symbols = g_new(const AztecSymbol*, count);
+                memcpy(reader->symbols, symbols, sizeof(symbols[0]) * count);
+            }
+            reader->count = count;
+            reader->columns = columns;
+            reader->cell = size + 2 * border;
+            reader->modules = ((count + reader->columns - 1) /
+                reader->columns) * reader->cell;
+            reader->scale = scale;
+            reader->border = border;
+            reader->msb = (format == AZTEC_PIXEL_MONO_MSB);
+            reader->width = (gsize) reader->columns * reader->cell * scale;
+            reader->height = (gsize) reader->modules * scale;
+            reader->rowsize = (reader->width + 7) / 8;
+            reader->row = g_malloc(reader->rowsize);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+void
+aztec_row_reader_deinit(
+    AztecRowReader* reader)
+{
+    if (reader->symbols != &reader->single) {
+        g_free(reader->symbols);
+    }
+    g_free(reader->row);
+}
+
+/*
+ * Returns the symbol in column x of the band containing module row y
+ * and the row of that symbol to be shown there, or NULL if that part
+ * of the cell is empty.
+ */
+static
+const guint8*
+aztec_row_reader_src(
+    const AztecRowReader* reader,
+    guint x,
+    guint y,
+    const AztecSymbol** symbol)
+{
+    const guint i = (y / reader->cell) * reader->columns + x;
+
+    if (i < reader->count && reader->symbols[i]) {
+        const AztecSymbol* s = reader->symbols[i];
+        const guint offset = reader->border +
+            (reader->cell - 2 * reader->border - s->size) / 2;
+        const guint sy = y % reader->cell;
+
+        if (sy >= offset && sy < offset + s->size) {
+            *symbol = s;
+            return s->rows[sy - offset];
+        }
+    }
+    return NULL;
+}
+
+static
+gboolean
+aztec_row_reader_same(
+    const AztecRowReader* reader,
+    guint y1,
+    guint y2)
+{
+    guint x;
+
+    for (x = 0; x < reader->columns; x++) {
+        const AztecSymbol* s1 = NULL;
+        const AztecSymbol* s2 = NULL;
+        const guint8* r1 = aztec_row_reader_src(reader, x, y1, &s1);
+        const guint8* r2 = aztec_row_reader_src(reader, x, y2, &s2);
+
+        if (r1 != r2 && (!r1 || !r2 || s1->size != s2->size ||
+            aztec_symbol_flags(s1) != aztec_symbol_flags(s2) ||
+            memcmp(r1, r2, (s1->size + 7) / 8))) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static
+void
+aztec_row_reader_render(
+    AztecRowReader* reader,
+    guint y)
+{
+    const guint cellsize = reader->cell * reader->scale;
+    guint x;
+
+    memset(reader->row, 0, reader->rowsize);
+    for (x = 0; x < reader->columns; x++) {
+        const AztecSymbol* s = NULL;
+        const guint8* src = aztec_row_reader_src(reader, x, y, &s);
+
+        if (src) {
+            const guint offset = reader->border +
+                (reader->cell - 2 * reader->border - s->size) / 2;
+
+            aztec_render_put_row(src, s->size, (aztec_symbol_flags(s) &
+                AZTEC_ENCODE_INV) != 0, reader->scale, (gsize) x * cellsize +
+                offset * reader->scale, reader->row);
+        }
+    }
+
+    if (reader->msb) {
+        gsize i;
+
+        for (i = 0; i < reader->rowsize; i++) {
+            reader->row[i] = aztec_symbol_reverse_bits(reader->row[i]);
+        }
+    }
+}
+
+static
+AztecRowReader*
+aztec_row_reader_alloc(
+    const AztecSymbol* const* symbols,
+    guint count,
+    guint columns,
+    AztecPixelFormat format,
+    guint scale,
+    guint border)
+{
+    AztecRowReader* reader = g_slice_new(AztecRowReader);
+
+    if (aztec_row_reader_init(reader, symbols, count, columns, format,
+        scale, border)) {
+        return reader;
+    }
+    g_slice_free(AztecRowReader, reader);
+    return NULL;
+}
+
+AztecRowReader*
+aztec_row_reader_new(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    guint scale,
+    guint border) /* Since 1.0.10 */
+{
+    return aztec_row_reader_alloc(&symbol, 1, 1, format, scale, border);
+}
+
+AztecRowReader*
+aztec_row_reader_new_sheet(
+    const AztecSymbol* const* symbols,
+    guint count,
+    guint columns,
+    AztecPixelFormat format,
+    guint scale,
+    guint border) /* Since 1.0.10 */
+{
+    return aztec_row_reader_alloc(symbols, count, columns, format, scale,
+        border);
+}
+
+void
+aztec_row_reader_free(
+    AztecRowReader* reader) /* Since 1.0.10 */
+{
+    if (reader) {
+        aztec_row_reader_deinit(reader);
+        g_slice_free(AztecRowReader, reader);
+    }
+}
+
+guint
+aztec_row_reader_width(
+    const AztecRowReader* reader) /* Since 1.0.10 */
+{
+    return reader ? (guint)reader->width : 0;
+}
+
+guint
+aztec_row_reader_height(
+    const AztecRowReader* reader) /* Since 1.0.10 */
+{
+    return reader ? (guint)reader->height : 0;
+}
+
+gsize
+aztec_row_reader_rowsize(
+    const AztecRowReader* reader) /* Since 1.0.10 */
+{
+    return reader ? reader->rowsize : 0;
+}
+
+AztecPixelFormat
+aztec_row_reader_format(
+    const AztecRowReader* reader) /* Since 1.0.10 */
+{
+    return (reader && !reader->msb) ? AZTEC_PIXEL_MONO_LSB :
+        AZTEC_PIXEL_MONO_MSB;
+}
+
+const guint8*
+aztec_row_reader_next(
+    AztecRowReader* reader,
+    guint* repeat) /* Since 1.0.10 */
+{
+    if (reader && reader->y < reader->modules) {
+        const guint y = reader->y;
+        guint next;
+
+        /* Identical rows are rendered once */
+        for (next = y + 1; next < reader->modules &&
+            aztec_row_reader_same(reader, y, next); next++);
+
+        aztec_row_reader_render(reader, y);
+        reader->y = next;
+        if (repeat) {
+            *repeat = (next - y) * reader->scale;
+        }
+        return reader->row;
+    }
+    return NULL;
+}
+
+gboolean
+aztec_symbol_render(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    guint scale,
+    guint border,
+    AztecRenderFunc func,
+    gpointer user_data) /* Since 1.0.10 */
+{
+    gboolean ok = FALSE;
+    AztecRowReader reader;
+
+    if (func && aztec_row_reader_init(&reader, &symbol, 1, 1, format, scale,
+        border)) {
+        const guint8* row;
+        guint repeat;
+
+        ok = TRUE;
+        while (ok && (row = aztec_row_reader_next(&reader, &repeat)) != NULL) {
+            ok = func(row, reader.rowsize, repeat, user_data);
+        }
+        aztec_row_reader_deinit(&reader);
+    }
+    return ok;
+}
+
+gboolean
+aztec_symbol_foreach_row(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    AztecSymbolRowFunc func,
+    gpointer user_data) /* Since 1.0.10 */
+{
+    if (symbol && func && (format == AZTEC_PIXEL_MONO_LSB ||
+        format == AZTEC_PIXEL_MONO_MSB)) {
+        const guint size = symbol->size;
+        const gsize rowsize = (size + 7) / 8;
+        const gboolean inv = (aztec_symbol_flags(symbol) &
+            AZTEC_ENCODE_INV) != 0;
+        gboolean ok = TRUE;
+        guint y;
+
+        if (inv == (format == AZTEC_PIXEL_MONO_MSB)) {
+            /* No conversion is necessary */
+            for (y = 0; y < size && ok; y++) {
+                ok = func(y, symbol->rows[y], rowsize, user_data);
+            }
+        } else {
+            guint8* row = g_malloc(rowsize);
+
+            for (y = 0; y < size && ok; y++) {
+                const guint8* src = symbol->rows[y];
+                gsize i;
+
+                for (i = 0; i < rowsize; i++) {
+                    row[i] = aztec_symbol_reverse_bits(src[i]);
+                }
+                ok = func(y, row, rowsize, user_data);
+            }
+            g_free(row);
+        }
+        return ok;
+    }
+    return FALSE;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
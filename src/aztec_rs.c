@@ -35,6 +35,7 @@
  */
 
 #include "aztec_rs.h"
+#include "aztec_probes.h"
 
 #include <string.h>
 
@@ -207,10 +208,13 @@ aztec_rs_encode16_full(
     guint16* ecc,
     guint ecc_count)
 {
-    AztecRS* rs = aztec_rs_new_full(gfpoly, ecc_count, index);
+    AztecRS* rs;
 
+    AZTEC_PROBE3(rs_start, gfpoly, data_count, ecc_count);
+    rs = aztec_rs_new_full(gfpoly, ecc_count, index);
     aztec_rs_encode16(rs, data, data_count, ecc);
     aztec_rs_free(rs);
+    AZTEC_PROBE3(rs_done, gfpoly, data_count, ecc_count);
 }
 
 /*
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_stats.h"
+
+#include <string.h>
+
+#ifdef AZTEC_STATS
+
+#include <time.h>
+
+/*
+ * Each thread gets its own counters on the first use. The counters of
+ * the finished threads are added to aztec_stats_retired.
+ */
+static GMutex aztec_stats_mutex;
+static GSList* aztec_stats_threads;
+static AztecStats aztec_stats_retired;
+
+static
+void
+aztec_stats_sum(
+    AztecStats* dest,
+    const AztecStats* src)
+{
+    const guint64* in = (const guint64*)src;
+    guint64* out = (guint64*)dest;
+    guint i;
+
+    G_STATIC_ASSERT(sizeof(AztecStats) % sizeof(guint64) == 0);
+    for (i = 0; i < sizeof(AztecStats) / sizeof(guint64); i++) {
+        out[i] += __atomic_load_n(in + i, __ATOMIC_RELAXED);
+    }
+}
+
+static
+void
+aztec_stats_thread_free(
+    gpointer data)
+{
+    AztecStats* stats = data;
+
+    g_mutex_lock(&aztec_stats_mutex);
+    aztec_stats_threads = g_slist_remove(aztec_stats_threads, stats);
+    aztec_stats_sum(&aztec_stats_retired, stats);
+    g_mutex_unlock(&aztec_stats_mutex);
+    g_free(stats);
+}
+
+static GPrivate aztec_stats_key = G_PRIVATE_INIT(aztec_stats_thread_free);
+
+AztecStats*
+aztec_stats_thread(
+    void)
+{
+    AztecStats* stats = g_private_get(&aztec_stats_key);
+
+    if (G_UNLIKELY(!stats)) {
+        stats = g_new0(AztecStats, 1);
+        g_mutex_lock(&aztec_stats_mutex);
+        aztec_stats_threads = g_slist_prepend(aztec_stats_threads, stats);
+        g_mutex_unlock(&aztec_stats_mutex);
+        g_private_set(&aztec_stats_key, stats);
+    }
+    return stats;
+}
+
+guint64
+aztec_stats_now(
+    void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif /* AZTEC_STATS */
+
+gboolean
+aztec_stats_snapshot(
+    AztecStats* stats) /* Since 1.0.10 */
+{
+    memset(stats, 0, sizeof(*stats));
+#ifdef AZTEC_STATS
+    {
+        GSList* l;
+
+        g_mutex_lock(&aztec_stats_mutex);
+        aztec_stats_sum(stats, &aztec_stats_retired);
+        for (l = aztec_stats_threads; l; l = l->next) {
+            aztec_stats_sum(stats, l->data);
+        }
+        g_mutex_unlock(&aztec_stats_mutex);
+    }
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
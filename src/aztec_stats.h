@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef AZTEC_STATS_H
+#define AZTEC_STATS_H
+
+#include "aztec_encode.h"
+
+/*
+ * Instrumentation macros, compiled out unless AZTEC_STATS is defined.
+ * AZTEC_STATS_DECLARE() fetches the counters of the calling thread,
+ * AZTEC_STATS_TIMER() starts the clock and AZTEC_STATS_LAP() charges
+ * the time elapsed since the last lap to the stage.
+ */
+#ifdef AZTEC_STATS
+
+AztecStats*
+aztec_stats_thread(
+    void)
+    G_GNUC_INTERNAL;
+
+guint64
+aztec_stats_now(
+    void)
+    G_GNUC_INTERNAL;
+
+/* Only the owner thread writes, snapshots may read at any time */
+static
+inline
+void
+aztec_stats_add(
+    guint64* counter,
+    guint64 n)
+{
+    __atomic_store_n(counter, *counter + n, __ATOMIC_RELAXED);
+}
+
+static
+inline
+void
+aztec_stats_lap(
+    AztecStats* stats,
+    AztecStage stage,
+    guint64* timer)
+{
+    const guint64 now = aztec_stats_now();
+
+    aztec_stats_add(stats->ns + stage, now - *timer);
+    *timer = now;
+}
+
+#  define AZTEC_STATS_DECLARE(s) AztecStats* s = aztec_stats_thread()
+#  define AZTEC_STATS_ADD(s,field,n) aztec_stats_add(&(s)->field, n)
+#  define AZTEC_STATS_TIMER(t) guint64 t = aztec_stats_now()
+#  define AZTEC_STATS_LAP(s,stage,t) aztec_stats_lap(s, stage, &(t))
+
+#else
+
+#  define AZTEC_STATS_DECLARE(s)
+#  define AZTEC_STATS_ADD(s,field,n) ((void)0)
+#  define AZTEC_STATS_TIMER(t)
+#  define AZTEC_STATS_LAP(s,stage,t) ((void)0)
+
+#endif /* AZTEC_STATS */
+
+#define AZTEC_STATS_INC(s,field) AZTEC_STATS_ADD(s, field, 1)
+
+#endif /* AZTEC_STATS_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_symbol.h"
+
+/*
+ * Symbols are allocated as a single block:
+ *
+ * +-----------------+--------------------+------------------------+
+ * | AztecSymbolPriv | size x row pointer | size x (size + 7)/8    |
+ * +-----------------+--------------------+------------------------+
+ *
+ * Released symbols are kept in per-thread free lists, one list per
+ * symbol size. Row pointers survive the round trip, only the pixels
+ * get overwritten when the block is reused.
+ *
+ * Symbols are reference counted because the cache may hand out the
+ * same symbol to several callers.
+ */
+
+#define AZTEC_SYMBOL_POOL_CLASSES \
+    ((AZTEC_SYMBOL_MAX_SIZE - AZTEC_SYMBOL_MIN_SIZE)/2 + 1)
+
+typedef struct aztec_symbol_priv AztecSymbolPriv;
+struct aztec_symbol_priv {
+    AztecSymbolPriv* next;
+    gint ref_count;
+    guint flags;
+    AztecSymbol pub;
+};
+
+typedef struct aztec_symbol_pool {
+    AztecSymbolPriv* free[AZTEC_SYMBOL_POOL_CLASSES];
+    gsize bytes;
+} AztecSymbolPool;
+
+static void aztec_symbol_pool_free(gpointer data);
+static GPrivate aztec_symbol_pool_key = G_PRIVATE_INIT(aztec_symbol_pool_free);
+static gsize aztec_symbol_pool_limit = AZTEC_SYMBOL_POOL_DEFAULT_LIMIT;
+
+static
+inline
+AztecSymbolPriv*
+aztec_symbol_cast(
+    AztecSymbol* pub)
+{
+    return (AztecSymbolPriv*)((guint8*)pub -
+        G_STRUCT_OFFSET(AztecSymbolPriv,pub));
+}
+
+static
+inline
+gsize
+aztec_symbol_alloc_size(
+    guint size)
+{
+    return sizeof(AztecSymbolPriv) +
+        size * (sizeof(AztecSymbolRow) + (size + 7) / 8);
+}
+
+gsize
+aztec_symbol_bytes(
+    const AztecSymbol* symbol)
+{
+    return aztec_symbol_alloc_size(symbol->size);
+}
+
+guint
+aztec_symbol_flags(
+    const AztecSymbol* symbol)
+{
+    return aztec_symbol_cast((AztecSymbol*)symbol)->flags;
+}
+
+static
+inline
+gboolean
+aztec_symbol_pool_class(
+    guint size,
+    guint* index)
+{
+    if (size >= AZTEC_SYMBOL_MIN_SIZE && size <= AZTEC_SYMBOL_MAX_SIZE &&
+        (size & 1)) {
+        *index = (size - AZTEC_SYMBOL_MIN_SIZE) / 2;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static
+void
+aztec_symbol_pool_clear(
+    AztecSymbolPool* pool)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(pool->free); i++) {
+        AztecSymbolPriv* priv = pool->free[i];
+
+        while (priv) {
+            AztecSymbolPriv* next = priv->next;
+
+            g_free(priv);
+            priv = next;
+        }
+        pool->free[i] = NULL;
+    }
+    pool->bytes = 0;
+}
+
+static
+void
+aztec_symbol_pool_free(
+    gpointer data)
+{
+    AztecSymbolPool* pool = data;
+
+    aztec_symbol_pool_clear(pool);
+    g_slice_free1(sizeof(*pool), pool);
+}
+
+AztecSymbol*
+aztec_symbol_alloc(
+    guint size,
+    guint flags)
+{
+    AztecSymbolPool* pool = g_private_get(&aztec_symbol_pool_key);
+    AztecSymbolPriv* priv;
+    AztecSymbol* symbol;
+    AztecSymbolRow* rows;
+    const gsize rowsize = (size + 7) / 8;
+    guint8* data;
+    guint i;
+
+    if (pool && aztec_symbol_pool_class(size, &i) && pool->free[i]) {
+        /* Row pointers are already there */
+        priv = pool->free[i];
+        pool->free[i] = priv->next;
+        pool->bytes -= aztec_symbol_alloc_size(size);
+        priv->next = NULL;
+        priv->flags = flags;
+        g_atomic_int_set(&priv->ref_count, 1);
+        return &priv->pub;
+    }
+
+    priv = g_malloc(aztec_symbol_alloc_size(size));
+    symbol = &priv->pub;
+    rows = (AztecSymbolRow*)(priv + 1);
+    data = (guint8*)(rows + size);
+
+    priv->next = NULL;
+    priv->flags = flags;
+    g_atomic_int_set(&priv->ref_count, 1);
+    symbol->size = size;
+    symbol->rows = rows;
+    for (i = 0; i < size; i++) {
+        rows[i] = data + i * rowsize;
+    }
+    return symbol;
+}
+
+static
+void
+aztec_symbol_release(
+    AztecSymbolPriv* priv)
+{
+    const guint size = priv->pub.size;
+    const gsize bytes = aztec_symbol_alloc_size(size);
+    const gsize limit = g_atomic_pointer_get(&aztec_symbol_pool_limit);
+    guint i;
+
+    if (bytes <= limit && aztec_symbol_pool_class(size, &i)) {
+        AztecSymbolPool* pool = g_private_get(&aztec_symbol_pool_key);
+
+        if (!pool) {
+            pool = g_slice_new0(AztecSymbolPool);
+            g_private_set(&aztec_symbol_pool_key, pool);
+        }
+        if (pool->bytes + bytes <= limit) {
+            priv->next = pool->free[i];
+            pool->free[i] = priv;
+            pool->bytes += bytes;
+            return;
+        }
+    }
+    g_free(priv);
+}
+
+AztecSymbol*
+aztec_symbol_ref(
+    AztecSymbol* symbol) /* Since 1.0.10 */
+{
+    if (symbol) {
+        g_atomic_int_inc(&aztec_symbol_cast(symbol)->ref_count);
+    }
+    return symbol;
+}
+
+void
+aztec_symbol_free(
+    AztecSymbol* symbol)
+{
+    if (symbol) {
+        AztecSymbolPriv* priv = aztec_symbol_cast(symbol);
+
+        if (g_atomic_int_dec_and_test(&priv->ref_count)) {
+            aztec_symbol_release(priv);
+        }
+    }
+}
+
+void
+aztec_symbol_pool_set_limit(
+    gsize bytes) /* Since 1.0.10 */
+{
+    g_atomic_pointer_set(&aztec_symbol_pool_limit, bytes);
+}
+
+gsize
+aztec_symbol_pool_get_limit(
+    void) /* Since 1.0.10 */
+{
+    return g_atomic_pointer_get(&aztec_symbol_pool_limit);
+}
+
+void
+aztec_symbol_pool_trim(
+    void) /* Since 1.0.10 */
+{
+    AztecSymbolPool* pool = g_private_get(&aztec_symbol_pool_key);
+
+    if (pool) {
+        aztec_symbol_pool_clear(pool);
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
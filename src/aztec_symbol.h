@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef AZTEC_SYMBOL_H
+#define AZTEC_SYMBOL_H
+
+#include "aztec_encode.h"
+
+/* Symbol sizes are odd numbers from 15x15 (compact) to 151x151 (full) */
+#define AZTEC_SYMBOL_MIN_SIZE (15)
+#define AZTEC_SYMBOL_MAX_SIZE (151)
+
+/* Per-thread pool budget, enough for a dozen of the largest symbols */
+#define AZTEC_SYMBOL_POOL_DEFAULT_LIMIT (64*1024)
+
+/*
+ * Allocates a symbol with the row pointers set up. Row contents are
+ * undefined, the caller must fill each row completely. Flags are the
+ * AZTEC_ENCODE_xxx flags the symbol is encoded with.
+ */
+AztecSymbol*
+aztec_symbol_alloc(
+    guint size,
+    guint flags)
+    G_GNUC_INTERNAL;
+
+guint
+aztec_symbol_flags(
+    const AztecSymbol* symbol)
+    G_GNUC_INTERNAL;
+
+/* Size of the memory block occupied by the symbol */
+gsize
+aztec_symbol_bytes(
+    const AztecSymbol* symbol)
+    G_GNUC_INTERNAL;
+
+/* Reverses the bit order in a byte */
+static
+inline
+guint8
+aztec_symbol_reverse_bits(
+    guint8 b)
+{
+    b = ((b & 0xf0) >> 4) | ((b & 0x0f) << 4);
+    b = ((b & 0xcc) >> 2) | ((b & 0x33) << 2);
+    return ((b & 0xaa) >> 1) | ((b & 0x55) << 1);
+}
+
+#endif /* AZTEC_SYMBOL_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
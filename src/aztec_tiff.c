@@ -0,0 +1,503 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_tiff.h"
+#include "aztec_render.h"
+
+#include <string.h>
+
+/*
+ * CCITT T.6 (Group 4) encoder. Each row is turned into the list of
+ * its changing elements (positions where the color differs from the
+ * pixel on the left, starting with white) and coded against the list
+ * of the previous row. A row which is identical to the previous one
+ * codes as V0 for every changing element plus one more V0 for the end
+ * of the row, i.e. it's just a sequence of ones. That's what scaled
+ * rows are, so only distinct rows need to be looked at.
+ */
+
+typedef struct aztec_g4_code {
+    guint16 code;
+    guint8 len;
+} AztecG4Code;
+
+typedef struct aztec_g4_writer {
+    GByteArray* out;
+    guint64 acc;
+    guint bits;
+} AztecG4Writer;
+
+/*
+ * Run length codes. Terminating codes (0..63) are followed by make-up
+ * codes (64..1728) and extended make-up codes (1792..2560) which are
+ * the same for both colors.
+ */
+static const AztecG4Code aztec_g4_white[] = {
+    { 0x035, 8 }, { 0x007, 6 }, { 0x007, 4 }, { 0x008, 4 }, { 0x00b, 4 },
+    { 0x00c, 4 }, { 0x00e, 4 }, { 0x00f, 4 }, { 0x013, 5 }, { 0x014, 5 },
+    { 0x007, 5 }, { 0x008, 5 }, { 0x008, 6 }, { 0x003, 6 }, { 0x034, 6 },
+    { 0x035, 6 }, { 0x02a, 6 }, { 0x02b, 6 }, { 0x027, 7 }, { 0x00c, 7 },
+    { 0x008, 7 }, { 0x017, 7 }, { 0x003, 7 }, { 0x004, 7 }, { 0x028, 7 },
+    { 0x02b, 7 }, { 0x013, 7 }, { 0x024, 7 }, { 0x018, 7 }, { 0x002, 8 },
+    { 0x003, 8 }, { 0x01a, 8 }, { 0x01b, 8 }, { 0x012, 8 }, { 0x013, 8 },
+    { 0x014, 8 }, { 0x015, 8 }, { 0x016, 8 }, { 0x017, 8 }, { 0x028, 8 },
+    { 0x029, 8 }, { 0x02a, 8 }, { 0x02b, 8 }, { 0x02c, 8 }, { 0x02d, 8 },
+    { 0x004, 8 }, { 0x005, 8 }, { 0x00a, 8 }, { 0x00b, 8 }, { 0x052, 8 },
+    { 0x053, 8 }, { 0x054, 8 }, { 0x055, 8 }, { 0x024, 8 }, { 0x025, 8 },
+    { 0x058, 8 }, { 0x059, 8 }, { 0x05a, 8 }, { 0x05b, 8 }, { 0x04a, 8 },
+    { 0x04b, 8 }, { 0x032, 8 }, { 0x033, 8 }, { 0x034, 8 }, { 0x01b, 5 },
+    { 0x012, 5 }, { 0x017, 6 }, { 0x037, 7 }, { 0x036, 8 }, { 0x037, 8 },
+    { 0x064, 8 }, { 0x065, 8 }, { 0x068, 8 }, { 0x067, 8 }, { 0x0cc, 9 },
+    { 0x0cd, 9 }, { 0x0d2, 9 }, { 0x0d3, 9 }, { 0x0d4, 9 }, { 0x0d5, 9 },
+    { 0x0d6, 9 }, { 0x0d7, 9 }, { 0x0d8, 9 }, { 0x0d9, 9 }, { 0x0da, 9 },
+    { 0x0db, 9 }, { 0x098, 9 }, { 0x099, 9 }, { 0x09a, 9 }, { 0x018, 6 },
+    { 0x09b, 9 }, { 0x008, 11 }, { 0x00c, 11 }, { 0x00d, 11 },
+    { 0x012, 12 }, { 0x013, 12 }, { 0x014, 12 }, { 0x015, 12 },
+    { 0x016, 12 }, { 0x017, 12 }, { 0x01c, 12 }, { 0x01d, 12 },
+    { 0x01e, 12 }, { 0x01f, 12 },
+};
+
+static const AztecG4Code aztec_g4_black[] = {
+    { 0x037, 10 }, { 0x002, 3 }, { 0x003, 2 }, { 0x002, 2 }, { 0x003, 3 },
+    { 0x003, 4 }, { 0x002, 4 }, { 0x003, 5 }, { 0x005, 6 }, { 0x004, 6 },
+    { 0x004, 7 }, { 0x005, 7 }, { 0x007, 7 }, { 0x004, 8 }, { 0x007, 8 },
+    { 0x018, 9 }, { 0x017, 10 }, { 0x018, 10 }, { 0x008, 10 },
+    { 0x067, 11 }, { 0x068, 11 }, { 0x06c, 11 }, { 0x037, 11 },
+    { 0x028, 11 }, { 0x017, 11 }, { 0x018, 11 }, { 0x0ca, 12 },
+    { 0x0cb, 12 }, { 0x0cc, 12 }, { 0x0cd, 12 }, { 0x068, 12 },
+    { 0x069, 12 }, { 0x06a, 12 }, { 0x06b, 12 }, { 0x0d2, 12 },
+    { 0x0d3, 12 }, { 0x0d4, 12 }, { 0x0d5, 12 }, { 0x0d6, 12 },
+    { 0x0d7, 12 }, { 0x06c, 12 }, { 0x06d, 12 }, { 0x0da, 12 },
+    { 0x0db, 12 }, { 0x054, 12 }, { 0x055, 12 }, { 0x056, 12 },
+    { 0x057, 12 }, { 0x064, 12 }, { 0x065, 12 }, { 0x052, 12 },
+    { 0x053, 12 }, { 0x024, 12 }, { 0x037, 12 }, { 0x038, 12 },
+    { 0x027, 12 }, { 0x028, 12 }, { 0x058, 12 }, { 0x059, 12 },
+    { 0x02b, 12 }, { 0x02c, 12 }, { 0x05a, 12 }, { 0x066, 12 },
+    { 0x067, 12 }, { 0x00f, 10 }, { 0x0c8, 12 }, { 0x0c9, 12 },
+    { 0x05b, 12 }, { 0x033, 12 }, { 0x034, 12 }, { 0x035, 12 },
+    { 0x06c, 13 }, { 0x06d, 13 }, { 0x04a, 13 }, { 0x04b, 13 },
+    { 0x04c, 13 }, { 0x04d, 13 }, { 0x072, 13 }, { 0x073, 13 },
+    { 0x074, 13 }, { 0x075, 13 }, { 0x076, 13 }, { 0x077, 13 },
+    { 0x052, 13 }, { 0x053, 13 }, { 0x054, 13 }, { 0x055, 13 },
+    { 0x05a, 13 }, { 0x05b, 13 }, { 0x064, 13 }, { 0x065, 13 },
+    { 0x008, 11 }, { 0x00c, 11 }, { 0x00d, 11 }, { 0x012, 12 },
+    { 0x013, 12 }, { 0x014, 12 }, { 0x015, 12 }, { 0x016, 12 },
+    { 0x017, 12 }, { 0x01c, 12 }, { 0x01d, 12 }, { 0x01e, 12 },
+    { 0x01f, 12 },
+};
+
+#define AZTEC_G4_MAX_MAKEUP_INDEX (G_N_ELEMENTS(aztec_g4_white) - 1)
+
+/* VL3, VL2, VL1, V0, VR1, VR2, VR3 */
+static const AztecG4Code aztec_g4_vertical[] = {
+    { 0x02, 7 }, { 0x02, 6 }, { 0x2, 3 }, { 0x1, 1 },
+    { 0x3, 3 }, { 0x03, 6 }, { 0x03, 7 }
+};
+
+static const AztecG4Code aztec_g4_pass = { 0x1, 4 };
+static const AztecG4Code aztec_g4_horizontal = { 0x1, 3 };
+static const AztecG4Code aztec_g4_eol = { 0x001, 12 };
+
+static inline
+void
+aztec_g4_put(
+    AztecG4Writer* w,
+    guint32 code,
+    guint len) /* len <= 32 */
+{
+    w->acc = (w->acc << len) | code;
+    w->bits += len;
+    if (w->bits >= 32) {
+        const guint32 word = (guint32) (w->acc >> (w->bits -= 32));
+        guint8 buf[4];
+
+        buf[0] = (guint8) (word >> 24);
+        buf[1] = (guint8) (word >> 16);
+        buf[2] = (guint8) (word >> 8);
+        buf[3] = (guint8) word;
+        g_byte_array_append(w->out, buf, sizeof(buf));
+    }
+}
+
+static inline
+void
+aztec_g4_put_code(
+    AztecG4Writer* w,
+    const AztecG4Code* code)
+{
+    aztec_g4_put(w, code->code, code->len);
+}
+
+static
+void
+aztec_g4_put_ones(
+    AztecG4Writer* w,
+    guint64 count)
+{
+    while (count >= 32) {
+        aztec_g4_put(w, 0xffffffff, 32);
+        count -= 32;
+    }
+    if (count) {
+        aztec_g4_put(w, (1u << count) - 1, (guint) count);
+    }
+}
+
+static
+void
+aztec_g4_put_span(
+    AztecG4Writer* w,
+    guint span,
+    const AztecG4Code* table)
+{
+    while (span >= 2560 + 64) {
+        aztec_g4_put_code(w, table + AZTEC_G4_MAX_MAKEUP_INDEX);
+        span -= 2560;
+    }
+    if (span >= 64) {
+        aztec_g4_put_code(w, table + 63 + (span >> 6));
+        span &= 63;
+    }
+    aztec_g4_put_code(w, table + span);
+}
+
+static
+void
+aztec_g4_finish(
+    AztecG4Writer* w)
+{
+    /* EOFB and padding to the byte boundary */
+    aztec_g4_put_code(w, &aztec_g4_eol);
+    aztec_g4_put_code(w, &aztec_g4_eol);
+    if (w->bits & 7) {
+        aztec_g4_put(w, 0, 8 - (w->bits & 7));
+    }
+    while (w->bits) {
+        const guint8 byte = (guint8) (w->acc >> (w->bits -= 8));
+
+        g_byte_array_append(w->out, &byte, 1);
+    }
+}
+
+/*
+ * Fills the list of changing elements and returns their number. The
+ * list is terminated by three width entries (a1, a2, b1 and b2 may
+ * all point past the last real changing element).
+ */
+static
+guint
+aztec_g4_changes(
+    const guint8* row,
+    gint width,
+    gint* changes)
+{
+    guint8 flip = 0;
+    guint n = 0;
+    gint x;
+
+    for (x = 0; x < width; x += 8, row++) {
+        guint b = *row ^ flip;
+
+        while (b) {
+            const guint bit = g_bit_nth_msf(b, -1);
+            const gint pos = x + 7 - bit;
+
+            if (pos >= width) {
+                break;
+            }
+            changes[n++] = pos;
+            flip ^= 0xff;
+            b = (*row ^ flip) & ((1u << bit) - 1);
+        }
+    }
+    changes[n] = changes[n + 1] = changes[n + 2] = width;
+    return n;
+}
+
+static
+void
+aztec_g4_encode_row(
+    AztecG4Writer* w,
+    const gint* cur,
+    const gint* ref,
+    gint width)
+{
+    gint a0 = -1;
+    guint i = 0, j = 0, color = 0;
+
+    do {
+        const gint a1 = cur[i];
+        guint k;
+        gint b1, b2;
+
+        /*
+         * b1 is the first changing element on the reference line to
+         * the right of a0 and of the opposite color. Even elements
+         * change the color to black, odd ones back to white.
+         */
+        while (ref[j] <= a0) j++;
+        k = j + ((j & 1) != color);
+        b1 = ref[k];
+        b2 = ref[k + 1];
+
+        if (b2 < a1) {
+            aztec_g4_put_code(w, &aztec_g4_pass);
+            a0 = b2;
+        } else if (a1 - b1 >= -3 && a1 - b1 <= 3) {
+            aztec_g4_put_code(w, aztec_g4_vertical + (a1 - b1 + 3));
+            a0 = a1;
+            color ^= 1;
+            i++;
+        } else {
+            const gint a2 = cur[i + 1];
+
+            aztec_g4_put_code(w, &aztec_g4_horizontal);
+            if (color) {
+                aztec_g4_put_span(w, a1 - a0, aztec_g4_black);
+                aztec_g4_put_span(w, a2 - a1, aztec_g4_white);
+            } else {
+                aztec_g4_put_span(w, a1 - MAX(a0, 0), aztec_g4_white);
+                aztec_g4_put_span(w, a2 - a1, aztec_g4_black);
+            }
+            a0 = a2;
+            i += 2;
+        }
+    } while (a0 < width);
+}
+
+static
+GByteArray*
+aztec_g4_encode(
+    AztecRowReader* reader,
+    guint* rows)
+{
+    if (reader && aztec_row_reader_format(reader) == AZTEC_PIXEL_MONO_MSB) {
+        const gint width = aztec_row_reader_width(reader);
+        gint* buf = g_new(gint, 2 * (width + 3));
+        gint* cur = buf;
+        gint* ref = buf + (width + 3);
+        const guint8* row;
+        AztecG4Writer w;
+        guint repeat, height = 0;
+
+        w.out = g_byte_array_sized_new(width * 4 + 16);
+        w.acc = 0;
+        w.bits = 0;
+
+        /* The imaginary line above the image is white */
+        ref[0] = ref[1] = ref[2] = width;
+        while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+            const guint n = aztec_g4_changes(row, width, cur);
+            gint* tmp = ref;
+
+            aztec_g4_encode_row(&w, cur, ref, width);
+            aztec_g4_put_ones(&w, (guint64) (repeat - 1) * (n + 1));
+            ref = cur;
+            cur = tmp;
+            height += repeat;
+        }
+        aztec_g4_finish(&w);
+
+        g_free(buf);
+        if (rows) {
+            *rows = height;
+        }
+        return w.out;
+    }
+    return NULL;
+}
+
+GBytes*
+aztec_row_reader_g4(
+    AztecRowReader* reader) /* Since 1.0.10 */
+{
+    GByteArray* data = aztec_g4_encode(reader, NULL);
+
+    return data ? g_byte_array_free_to_bytes(data) : NULL;
+}
+
+GBytes*
+aztec_symbol_g4(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border) /* Since 1.0.10 */
+{
+    AztecRowReader* reader = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, scale, border);
+    GBytes* g4 = aztec_row_reader_g4(reader);
+
+    aztec_row_reader_free(reader);
+    return g4;
+}
+
+/*
+ * TIFF writer. Everything is little-endian, the IFD immediately
+ * follows the header and is followed by the resolution rationals
+ * and the image data.
+ */
+
+#define AZTEC_TIFF_HEADER_SIZE (8)
+#define AZTEC_TIFF_ENTRY_COUNT (12)
+#define AZTEC_TIFF_IFD_SIZE (2 + 12 * AZTEC_TIFF_ENTRY_COUNT + 4)
+#define AZTEC_TIFF_RATIONALS_OFFSET \
+    (AZTEC_TIFF_HEADER_SIZE + AZTEC_TIFF_IFD_SIZE)
+#define AZTEC_TIFF_DATA_OFFSET (AZTEC_TIFF_RATIONALS_OFFSET + 16)
+
+#define AZTEC_TIFF_SHORT (3)
+#define AZTEC_TIFF_LONG (4)
+#define AZTEC_TIFF_RATIONAL (5)
+
+static
+guint8*
+aztec_tiff_put16(
+    guint8* ptr,
+    guint16 value)
+{
+    ptr[0] = (guint8) value;
+    ptr[1] = (guint8) (value >> 8);
+    return ptr + 2;
+}
+
+static
+guint8*
+aztec_tiff_put32(
+    guint8* ptr,
+    guint32 value)
+{
+    ptr[0] = (guint8) value;
+    ptr[1] = (guint8) (value >> 8);
+    ptr[2] = (guint8) (value >> 16);
+    ptr[3] = (guint8) (value >> 24);
+    return ptr + 4;
+}
+
+static
+guint8*
+aztec_tiff_put_entry(
+    guint8* ptr,
+    guint16 tag,
+    guint16 type,
+    guint32 value)
+{
+    ptr = aztec_tiff_put16(ptr, tag);
+    ptr = aztec_tiff_put16(ptr, type);
+    ptr = aztec_tiff_put32(ptr, 1);
+    if (type == AZTEC_TIFF_SHORT) {
+        /* Left-justified in the 4-byte value field */
+        ptr = aztec_tiff_put16(ptr, (guint16) value);
+        return aztec_tiff_put16(ptr, 0);
+    } else {
+        return aztec_tiff_put32(ptr, value);
+    }
+}
+
+GBytes*
+aztec_row_reader_tiff(
+    AztecRowReader* reader,
+    guint dpi) /* Since 1.0.10 */
+{
+    const guint width = aztec_row_reader_width(reader);
+    guint height = 0;
+
+    /* The reader may have been partially consumed */
+    GByteArray* data = aztec_g4_encode(reader, &height);
+
+    if (data) {
+        const guint len = data->len;
+        GByteArray* out = g_byte_array_sized_new(AZTEC_TIFF_DATA_OFFSET + len);
+        guint8* ptr;
+
+        g_byte_array_set_size(out, AZTEC_TIFF_DATA_OFFSET);
+        ptr = out->data;
+        *ptr++ = 'I';
+        *ptr++ = 'I';
+        ptr = aztec_tiff_put16(ptr, 42);
+        ptr = aztec_tiff_put32(ptr, AZTEC_TIFF_HEADER_SIZE);
+
+        /* Entries must be sorted by tag */
+        ptr = aztec_tiff_put16(ptr, AZTEC_TIFF_ENTRY_COUNT);
+        ptr = aztec_tiff_put_entry(ptr, 256, AZTEC_TIFF_LONG, width);
+        ptr = aztec_tiff_put_entry(ptr, 257, AZTEC_TIFF_LONG, height);
+        ptr = aztec_tiff_put_entry(ptr, 258, AZTEC_TIFF_SHORT, 1);
+        ptr = aztec_tiff_put_entry(ptr, 259, AZTEC_TIFF_SHORT, 4); /* G4 */
+        ptr = aztec_tiff_put_entry(ptr, 262, AZTEC_TIFF_SHORT, 0);
+        ptr = aztec_tiff_put_entry(ptr, 273, AZTEC_TIFF_LONG,
+            AZTEC_TIFF_DATA_OFFSET);
+        ptr = aztec_tiff_put_entry(ptr, 277, AZTEC_TIFF_SHORT, 1);
+        ptr = aztec_tiff_put_entry(ptr, 278, AZTEC_TIFF_LONG, height);
+        ptr = aztec_tiff_put_entry(ptr, 279, AZTEC_TIFF_LONG, len);
+        ptr = aztec_tiff_put_entry(ptr, 282, AZTEC_TIFF_RATIONAL,
+            AZTEC_TIFF_RATIONALS_OFFSET);
+        ptr = aztec_tiff_put_entry(ptr, 283, AZTEC_TIFF_RATIONAL,
+            AZTEC_TIFF_RATIONALS_OFFSET + 8);
+        ptr = aztec_tiff_put_entry(ptr, 296, AZTEC_TIFF_SHORT, dpi ? 2 : 1);
+        ptr = aztec_tiff_put32(ptr, 0);
+
+        /* XResolution and YResolution */
+        ptr = aztec_tiff_put32(ptr, dpi ? dpi : 1);
+        ptr = aztec_tiff_put32(ptr, 1);
+        ptr = aztec_tiff_put32(ptr, dpi ? dpi : 1);
+        aztec_tiff_put32(ptr, 1);
+
+        g_byte_array_append(out, data->data, len);
+        g_byte_array_unref(data);
+        return g_byte_array_free_to_bytes(out);
+    }
+    return NULL;
+}
+
+GBytes*
+aztec_symbol_tiff(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border,
+    guint dpi) /* Since 1.0.10 */
+{
+    AztecRowReader* reader = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, scale, border);
+    GBytes* tiff = aztec_row_reader_tiff(reader, dpi);
+
+    aztec_row_reader_free(reader);
+    return tiff;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,587 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_render.h"
+#include "aztec_tiff.h"
+#include "tool_batch.h"
+#include "tool_stats.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#define RET_OK 0
+#define RET_ERR 1
+#define RET_CMDLINE 2
+
+typedef enum pbm_format {
+    PBM_FORMAT_PBM,     /* P4, 1 bpp, MSB first, 1 is black */
+    PBM_FORMAT_PGM,     /* P5, 8 bpp, 0 is black */
+    PBM_FORMAT_RAW,     /* Same as P4 without the header */
+    PBM_FORMAT_TIFF     /* Bilevel TIFF, CCITT Group 4 compression */
+} PBM_FORMAT;
+
+static const char* pbm_formats[] = {
+    "pbm", "pgm", "raw", "tiff"
+};
+
+typedef struct app_options {
+    int scale;
+    int border;
+    int dpi;
+    PBM_FORMAT format;
+} AppOptions;
+
+/* Enough for the largest unscaled symbol plus the header */
+#define PBM_IOV_COUNT 256
+
+typedef struct pbm_writer {
+    FILE* out;
+    int fd;             /* Negative if there's no file descriptor */
+    gboolean ok;
+    guint n;
+    struct iovec iov[PBM_IOV_COUNT];
+    guint8* gray;       /* PGM row buffer */
+    gsize width;        /* PGM row size */
+} PbmWriter;
+
+/* Each byte of a 1-bpp row expands into 8 gray pixels */
+static guint8 pgm_expand[256][8];
+
+static
+G_GNUC_PRINTF(1,2)
+void
+errmsg(
+    const char* format,
+    ...)
+{
+    va_list va;
+    va_start(va, format);
+    vfprintf(stderr, format, va);
+    va_end(va);
+}
+
+static
+void
+pgm_expand_init(
+    void)
+{
+    guint i, j;
+
+    for (i = 0; i < 256; i++) {
+        for (j = 0; j < 8; j++) {
+            pgm_expand[i][j] = (i & (0x80 >> j)) ? 0 : 255;
+        }
+    }
+}
+
+static
+void
+pbm_writer_init(
+    PbmWriter* w,
+    FILE* out)
+{
+    memset(w, 0, sizeof(*w));
+    w->out = out;
+    w->ok = TRUE;
+
+    /* Memory streams (batch output to stdout) have no descriptor */
+    w->fd = fileno(out);
+    if (w->fd >= 0) {
+        fflush(out);
+    }
+}
+
+static
+void
+pbm_writer_flush(
+    PbmWriter* w)
+{
+    struct iovec* iov = w->iov;
+    int count = w->n;
+
+    if (w->fd < 0) {
+        int i;
+
+        for (i = 0; i < count && w->ok; i++) {
+            if (fwrite(iov[i].iov_base, 1, iov[i].iov_len, w->out) !=
+                iov[i].iov_len) {
+                w->ok = FALSE;
+            }
+        }
+    } else {
+        while (count > 0 && w->ok) {
+            ssize_t written = writev(w->fd, iov, count);
+
+            if (written < 0) {
+                if (errno != EINTR) {
+                    w->ok = FALSE;
+                }
+            } else {
+                /* Skip what's been written, retry the rest */
+                while (count > 0 && (gsize)written >= iov->iov_len) {
+                    written -= iov->iov_len;
+                    iov++;
+                    count--;
+                }
+                if (count > 0) {
+                    iov->iov_base = (char*)iov->iov_base + written;
+                    iov->iov_len -= written;
+                }
+            }
+        }
+    }
+    w->n = 0;
+}
+
+static
+void
+pbm_writer_add(
+    PbmWriter* w,
+    const void* data,
+    gsize len)
+{
+    if (w->n == PBM_IOV_COUNT) {
+        pbm_writer_flush(w);
+    }
+    w->iov[w->n].iov_base = (void*)data;
+    w->iov[w->n].iov_len = len;
+    w->n++;
+}
+
+static
+gboolean
+save_row(
+    const guint8* row,
+    gsize rowsize,
+    guint repeat,
+    gpointer user_data)
+{
+    PbmWriter* w = user_data;
+    guint i;
+
+    /* The rows are already in P4 layout, replicas are written as is */
+    for (i = 0; i < repeat; i++) {
+        pbm_writer_add(w, row, rowsize);
+    }
+    pbm_writer_flush(w);
+    return w->ok;
+}
+
+static
+gboolean
+save_pgm_row(
+    const guint8* row,
+    gsize rowsize,
+    guint repeat,
+    gpointer user_data)
+{
+    PbmWriter* w = user_data;
+    guint i;
+
+    for (i = 0; i < rowsize; i++) {
+        memcpy(w->gray + 8 * i, pgm_expand[row[i]], 8);
+    }
+    for (i = 0; i < repeat; i++) {
+        pbm_writer_add(w, w->gray, w->width);
+    }
+    pbm_writer_flush(w);
+    return w->ok;
+}
+
+static
+void
+save_header(
+    PbmWriter* w,
+    const AppOptions* opts,
+    guint width,
+    guint height,
+    char* buf,
+    gsize size)
+{
+    switch (opts->format) {
+    case PBM_FORMAT_PBM:
+        pbm_writer_add(w, buf, g_snprintf(buf, size, "P4\n%u %u\n",
+            width, height));
+        break;
+    case PBM_FORMAT_PGM:
+        pbm_writer_add(w, buf, g_snprintf(buf, size, "P5\n%u %u\n255\n",
+            width, height));
+        break;
+    case PBM_FORMAT_RAW:
+    case PBM_FORMAT_TIFF:
+        break;
+    }
+}
+
+static
+int
+save_finish(
+    PbmWriter* w,
+    FILE* out)
+{
+    const int ret = (w->ok && !ferror(out)) ? RET_OK : RET_ERR;
+
+    g_free(w);
+    return ret;
+}
+
+/* Writes the image produced by the reader (a symbol or a whole sheet) */
+static
+int
+save_image(
+    AztecRowReader* reader,
+    const AppOptions* opts,
+    FILE* out)
+{
+    const guint width = aztec_row_reader_width(reader);
+    const gsize rowsize = aztec_row_reader_rowsize(reader);
+    char header[32];
+    PbmWriter* w = g_new(PbmWriter, 1);
+    const guint8* row;
+    guint repeat;
+
+    pbm_writer_init(w, out);
+    save_header(w, opts, width, aztec_row_reader_height(reader), header,
+        sizeof(header));
+    if (opts->format == PBM_FORMAT_TIFF) {
+        GBytes* tiff = aztec_row_reader_tiff(reader, opts->dpi);
+        gsize size;
+        const void* data = g_bytes_get_data(tiff, &size);
+
+        pbm_writer_add(w, data, size);
+        pbm_writer_flush(w);
+        g_bytes_unref(tiff);
+    } else if (opts->format == PBM_FORMAT_PGM) {
+        w->width = width;
+        w->gray = g_malloc((width + 7) & ~7);
+        while ((row = aztec_row_reader_next(reader, &repeat)) != NULL &&
+            save_pgm_row(row, rowsize, repeat, w));
+        g_free(w->gray);
+    } else {
+        while ((row = aztec_row_reader_next(reader, &repeat)) != NULL &&
+            save_row(row, rowsize, repeat, w));
+    }
+    pbm_writer_flush(w);
+    return save_finish(w, out);
+}
+
+static
+int
+save_symbol(
+    const AztecSymbol* symbol,
+    const AppOptions* opts,
+    FILE* out)
+{
+    if (opts->scale == 1 && !opts->border &&
+        (opts->format == PBM_FORMAT_PBM || opts->format == PBM_FORMAT_RAW)) {
+        const gsize rowsize = (symbol->size + 7) / 8;
+        char header[32];
+        PbmWriter* w = g_new(PbmWriter, 1);
+        guint i;
+
+        /*
+         * Rows produced by aztec_encode_inv() are exactly what P4
+         * expects, the whole thing is written with a single writev().
+         */
+        pbm_writer_init(w, out);
+        save_header(w, opts, symbol->size, symbol->size, header,
+            sizeof(header));
+        for (i = 0; i < symbol->size; i++) {
+            pbm_writer_add(w, symbol->rows[i], rowsize);
+        }
+        pbm_writer_flush(w);
+        return save_finish(w, out);
+    } else {
+        AztecRowReader* reader = aztec_row_reader_new(symbol,
+            AZTEC_PIXEL_MONO_MSB, opts->scale, opts->border);
+        const int ret = save_image(reader, opts, out);
+
+        aztec_row_reader_free(reader);
+        return ret;
+    }
+}
+
+static
+gboolean
+save_batch_symbol(
+    const AztecSymbol* symbol,
+    FILE* out,
+    gpointer opts)
+{
+    return save_symbol(symbol, opts, out) == RET_OK;
+}
+
+static
+gboolean
+save_batch_sheet(
+    AztecRowReader* reader,
+    FILE* out,
+    gpointer opts)
+{
+    return save_image(reader, opts, out) == RET_OK;
+}
+
+static
+gboolean
+parse_format(
+    const char* value,
+    PBM_FORMAT* format)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(pbm_formats); i++) {
+        if (!g_ascii_strcasecmp(value, pbm_formats[i])) {
+            *format = (PBM_FORMAT)i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+int
+main(
+    int argc,
+    char* argv[])
+{
+    int ret = RET_ERR;
+    int errcorr = AZTEC_CORRECTION_DEFAULT;
+    int jobs = 0;
+    int sheet = 0;
+    const char* file = NULL;
+    const char* batch = NULL;
+    const char* format = NULL;
+    TOOL_BATCH_FORMAT batch_format = TOOL_BATCH_NONE;
+    gboolean ok;
+    gboolean stats = FALSE;
+    GError* error = NULL;
+    AppOptions opts;
+    GOptionContext* options;
+    GOptionEntry entries[] = {
+        { "scale", 's', 0, G_OPTION_ARG_INT, &opts.scale,
+          "Scale factor [1]", "SCALE" },
+        { "correction", 'c', 0, G_OPTION_ARG_INT, &errcorr,
+          "Error correction [23]", "PERCENT" },
+        { "border", 'b', 0, G_OPTION_ARG_INT, &opts.border,
+          "Border around the symbol [1]", "PIXELS" },
+        { "format", 'F', 0, G_OPTION_ARG_STRING, &format,
+          "Output format (pbm, pgm, raw or tiff) [pbm]", "FORMAT" },
+        { "dpi", 'd', 0, G_OPTION_ARG_INT, &opts.dpi,
+          "TIFF resolution [none]", "DPI" },
+        { "file", 'f', 0, G_OPTION_ARG_FILENAME, &file,
+          "Encode data from FILE", "FILE" },
+        { "batch", 'B', 0, G_OPTION_ARG_STRING, &batch,
+          "Encode each record (lines, nul or length)", "FORMAT" },
+        { "jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+          "Number of batch threads [all CPUs]", "N" },
+        { "sheet", 'S', 0, G_OPTION_ARG_INT, &sheet,
+          "Put all batch records on one sheet", "COLUMNS" },
+        { "stats", 0, 0, G_OPTION_ARG_NONE, &stats,
+          "Print encoder statistics to stderr", NULL },
+        { NULL }
+    };
+
+    memset(&opts, 0, sizeof(opts));
+    opts.scale = 1;
+    opts.border = 1;
+    opts.format = PBM_FORMAT_PBM;
+    options = g_option_context_new("[TEXT] OUTPUT");
+    g_option_context_add_main_entries(options, entries, NULL);
+    g_option_context_set_summary(options,
+        "Generates Aztec symbol as a PBM, PGM, raw 1-bpp bitmap or\n"
+        "G4 compressed TIFF.\n\n"
+        "If no text is provided on the command line, "
+        "reads the standard input.\n\n"
+        "In batch mode each input record is encoded separately, "
+        "OUTPUT is the file\nname template where %d (e.g. %04d) "
+        "is replaced with the record number.\nWith --sheet all records "
+        "go to a single image, OUTPUT is its file name.");
+    ok = g_option_context_parse(options, &argc, &argv, &error);
+    if (ok && format && !parse_format(format, &opts.format)) {
+        error = g_error_new(G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+            "Invalid output format \'%s\'", format);
+        ok = FALSE;
+    }
+    if (ok && batch && !tool_batch_parse_format(batch, &batch_format)) {
+        error = g_error_new(G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+            "Invalid batch format \'%s\'", batch);
+        ok = FALSE;
+    }
+    if (ok && opts.format == PBM_FORMAT_PGM) {
+        pgm_expand_init();
+    }
+
+    if (ok && batch_format && sheet > 0 && opts.scale > 0 &&
+        opts.border >= 0 && opts.dpi >= 0 && jobs >= 0 && argc == 2) {
+        GBytes* bytes = tool_read_input(file, &error);
+
+        if (bytes) {
+            GArray* items = tool_batch_split(bytes, batch_format, errcorr,
+                &error);
+
+            if (items) {
+                if (tool_batch_sheet(items, AZTEC_ENCODE_INV, argv[1], jobs,
+                    sheet, AZTEC_PIXEL_MONO_MSB, opts.scale, opts.border,
+                    save_batch_sheet, &opts)) {
+                    ret = RET_OK;
+                }
+                g_array_free(items, TRUE);
+            } else {
+                errmsg("%s\n", error->message);
+                g_error_free(error);
+            }
+            g_bytes_unref(bytes);
+        } else {
+            errmsg("%s\n", error->message);
+            g_error_free(error);
+        }
+    } else if (ok && batch_format && !sheet && opts.scale > 0 &&
+        opts.border >= 0 && opts.dpi >= 0 && jobs >= 0 && argc == 2) {
+        const char* templ = argv[1];
+        char* test = tool_batch_filename(templ, 1);
+
+        if (test || !strcmp(templ, "-")) {
+            GBytes* bytes = tool_read_input(file, &error);
+
+            if (bytes) {
+                GArray* items = tool_batch_split(bytes, batch_format,
+                    errcorr, &error);
+
+                if (items) {
+                    if (tool_batch_run(items, AZTEC_ENCODE_INV, templ,
+                        jobs, save_batch_symbol, &opts)) {
+                        ret = RET_OK;
+                    }
+                    g_array_free(items, TRUE);
+                } else {
+                    errmsg("%s\n", error->message);
+                    g_error_free(error);
+                }
+                g_bytes_unref(bytes);
+            } else {
+                errmsg("%s\n", error->message);
+                g_error_free(error);
+            }
+        } else {
+            errmsg("Invalid file name template \'%s\'\n", templ);
+            ret = RET_CMDLINE;
+        }
+        g_free(test);
+    } else if (ok && !batch_format && !sheet && opts.scale > 0 &&
+        opts.border >= 0 && opts.dpi >= 0 && (argc == 2 || (argc == 3 && !file))) {
+        const char* output = argv[argc - 1];
+        const void* data = NULL;
+        gsize size;
+        GBytes* bytes = NULL;
+
+        if (argc == 2) {
+            bytes = tool_read_input(file, &error);
+            if (!bytes) {
+                errmsg("%s\n", error->message);
+                g_error_free(error);
+            }
+        } else {
+            data = argv[1];
+            size = strlen(data);
+        }
+
+        if (bytes) {
+            data = g_bytes_get_data(bytes, &size);
+        }
+
+        if (data) {
+            if (size) {
+                /* P4 wants the left-most pixel in the MSB */
+                AztecSymbol* symbol = aztec_encode_inv(data, size, errcorr);
+
+                if (symbol) {
+                    FILE* f = NULL;
+                    FILE* out = NULL;
+
+                    if (!strcmp(output, "-")) {
+                        out = stdout;
+                    } else {
+                        out = f = fopen(output, "wb");
+                        if (!out) {
+                            errmsg("%s: %s\n", output, strerror(errno));
+                        }
+                    }
+
+                    if (out) {
+                        ret = save_symbol(symbol, &opts, out);
+                        if (f) {
+                            fclose(f);
+                        }
+                    }
+                    aztec_symbol_free(symbol);
+                } else {
+                    errmsg("Failed to generate symbol (too much data?)\n");
+                }
+            } else {
+                errmsg("Nothing to encode.\n");
+            }
+        }
+        if (bytes) {
+            g_bytes_unref(bytes);
+        }
+    } else {
+        if (error) {
+            errmsg("%s\n", error->message);
+            g_error_free(error);
+        } else {
+            char* help = g_option_context_get_help(options, TRUE, NULL);
+            errmsg("%s", help);
+            g_free(help);
+        }
+        ret = RET_CMDLINE;
+    }
+    if (stats && ret != RET_CMDLINE) {
+        tool_stats_print(stderr);
+    }
+    g_option_context_free(options);
+    return ret;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -34,9 +34,13 @@
  * any official policies, either expressed or implied.
  */
 
-#include "aztec_encode.h"
+#include "aztec_render.h"
+#include "rows_png.h"
+#include "tool_batch.h"
+#include "tool_stats.h"
 
 #include <png.h>
+#include <zlib.h>
 #include <errno.h>
 #include <stdio.h>
 #include <setjmp.h>
@@ -46,6 +50,23 @@
 #define RET_ERR 1
 #define RET_CMDLINE 2
 
+typedef enum compress_mode {
+    COMPRESS_DEFAULT,   /* libpng defaults */
+    COMPRESS_FAST,      /* libpng, fastest zlib level */
+    COMPRESS_NONE,      /* libpng, stored zlib blocks */
+    COMPRESS_ROWS       /* Our own bilevel deflate writer */
+} COMPRESS_MODE;
+
+static const char* compress_modes[] = {
+    "default", "fast", "none", "rows"
+};
+
+typedef struct save_options {
+    int scale;
+    int border;
+    COMPRESS_MODE compress;
+} SaveOptions;
+
 static
 G_GNUC_PRINTF(1,2)
 void
@@ -72,19 +93,31 @@ save_error(
     longjmp(*jmp, 1);
 }
 
+static
+gboolean
+save_row(
+    const guint8* row,
+    gsize rowsize,
+    guint repeat,
+    gpointer png)
+{
+    guint i;
+
+    for (i = 0; i < repeat; i++) {
+        png_write_row(png, (png_bytep)row);
+    }
+    return TRUE;
+}
+
 static
 int
-save_symbol(
-    AztecSymbol* symbol,
-    int scale,
-    int border,
+save_image_libpng(
+    AztecRowReader* reader,
+    const SaveOptions* opts,
     FILE* out)
 {
     int ret = RET_ERR;
-    const int bs = border * scale;
-    const int n = symbol->size * scale;
-    const int n2 = n + 2 * bs;
-    const int rowsize = (n2 + 7) / 8;
+    const gsize rowsize = aztec_row_reader_rowsize(reader);
     jmp_buf jmp;
     png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, &jmp,
         save_error, NULL);
@@ -93,75 +126,113 @@ save_symbol(
         png_infop info = png_create_info_struct(png);
 
         if (info) {
-            guint8* row = g_malloc(rowsize);
-
             if (!setjmp(jmp)) {
-                guint i;
+                const guint8* row;
+                guint repeat;
 
                 png_init_io(png, out);
                 png_set_filter(png, 0, PNG_FILTER_NONE);
-                png_set_IHDR(png, info, n2, n2, 1, PNG_COLOR_TYPE_GRAY,
+                switch (opts->compress) {
+                case COMPRESS_FAST:
+                    png_set_compression_level(png, Z_BEST_SPEED);
+                    break;
+                case COMPRESS_NONE:
+                    png_set_compression_level(png, Z_NO_COMPRESSION);
+                    break;
+                default:
+                    break;
+                }
+                png_set_IHDR(png, info, aztec_row_reader_width(reader),
+                    aztec_row_reader_height(reader), 1, PNG_COLOR_TYPE_GRAY,
                     PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
                     PNG_FILTER_TYPE_DEFAULT);
                 png_set_invert_mono(png); /* 1 is black */
                 png_write_info(png, info);
 
-                /* Top border */
-                memset(row, 0, rowsize);
-                for (i = 0; i < bs; i++) {
-                    png_write_row(png, (png_bytep)row);
-                }
-
-                /*
-                 * Transform the rows (scale and add borders) and at the
-                 * same time swap the bit order. In PNG most significant
-                 * bit codes the left-most pixel.
-                 */
-                for (i = 0; i < symbol->size; i++) {
-                    guint8* dest = row;
-                    guint8* end = dest + rowsize;
-                    const guint8* ptr = symbol->rows[i];
-                    int k, j, d = bs % 8;
-
-                    memset(row, 0, rowsize);
-                    dest += bs / 8;
-                    for (k = 0; k < symbol->size; k += 8) {
-                        guint8 byte = *ptr++;
-                        int b;
-
-                        for (b = 0; b < 8 && dest < end; b++, byte >>= 1) {
-                            const int bit = (byte & 1);
-
-                            for (j = 0; j < scale && dest < end; j++) {
-                                *dest <<= 1;
-                                *dest |= bit;
-                                if ((d++) == 7) {
-                                    d = 0;
-                                    dest++;
-                                }
-                            }
-                        }
-                    }
-                    for (j = 0; j < scale; j++) {
-                        png_write_row(png, (png_bytep)row);
-                    }
-                }
-
-                /* Bottom border */
-                memset(row, 0, rowsize);
-                for (i = 0; i < bs; i++) {
-                    png_write_row(png, (png_bytep)row);
-                }
+                while ((row = aztec_row_reader_next(reader, &repeat)) &&
+                    save_row(row, rowsize, repeat, png));
                 png_write_end(png, info);
                 ret = RET_OK;
             }
             png_destroy_write_struct(&png, &info);
-            g_free(row);
         }
     }
     return ret;
 }
 
+/* Writes the image produced by the reader (a symbol or a whole sheet) */
+static
+int
+save_image(
+    AztecRowReader* reader,
+    const SaveOptions* opts,
+    FILE* out)
+{
+    if (opts->compress == COMPRESS_ROWS &&
+        aztec_row_reader_rowsize(reader) <= ROWS_PNG_MAX_ROWSIZE) {
+        return rows_png_save(reader, out) ? RET_OK : RET_ERR;
+    } else {
+        return save_image_libpng(reader, opts, out);
+    }
+}
+
+static
+int
+save_symbol(
+    const AztecSymbol* symbol,
+    const SaveOptions* opts,
+    FILE* out)
+{
+    /* In PNG most significant bit codes the left-most pixel */
+    AztecRowReader* reader = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, opts->scale, opts->border);
+    const int ret = save_image(reader, opts, out);
+
+    aztec_row_reader_free(reader);
+    return ret;
+}
+
+static
+gboolean
+save_batch_symbol(
+    const AztecSymbol* symbol,
+    FILE* out,
+    gpointer user_data)
+{
+    const SaveOptions* opts = user_data;
+
+    return save_symbol(symbol, opts, out) == RET_OK;
+}
+
+static
+gboolean
+save_batch_sheet(
+    AztecRowReader* reader,
+    FILE* out,
+    gpointer user_data)
+{
+    const SaveOptions* opts = user_data;
+
+    return save_image(reader, opts, out) == RET_OK;
+}
+
+static
+gboolean
+parse_compress_mode(
+    const char* value,
+    COMPRESS_MODE* mode)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(compress_modes); i++) {
+        if (!g_ascii_strcasecmp(value, compress_modes[i])) {
+            *mode = (COMPRESS_MODE)i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 int
 main(
     int argc,
@@ -171,8 +242,15 @@ main(
     int scale = 1;
     int errcorr = AZTEC_CORRECTION_DEFAULT;
     int border = 1;
+    int jobs = 0;
+    int sheet = 0;
     const char* file = NULL;
+    const char* batch = NULL;
+    const char* compress = NULL;
+    SaveOptions save;
+    TOOL_BATCH_FORMAT format = TOOL_BATCH_NONE;
     gboolean ok;
+    gboolean stats = FALSE;
     GError* error = NULL;
     GOptionContext* options;
     GOptionEntry entries[] = {
@@ -184,6 +262,16 @@ main(
           "Border around the symbol [1]", "PIXELS" },
         { "file", 'f', 0, G_OPTION_ARG_FILENAME, &file,
           "Encode data from FILE", "FILE" },
+        { "batch", 'B', 0, G_OPTION_ARG_STRING, &batch,
+          "Encode each record (lines, nul or length)", "FORMAT" },
+        { "jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+          "Number of batch threads [all CPUs]", "N" },
+        { "compression", 'z', 0, G_OPTION_ARG_STRING, &compress,
+          "PNG compression (default, fast, none or rows)", "MODE" },
+        { "sheet", 'S', 0, G_OPTION_ARG_INT, &sheet,
+          "Put all batch records on one sheet", "COLUMNS" },
+        { "stats", 0, 0, G_OPTION_ARG_NONE, &stats,
+          "Print encoder statistics to stderr", NULL },
         { NULL }
     };
 
@@ -192,36 +280,91 @@ main(
     g_option_context_set_summary(options,
         "Generates Aztec symbol as a PNG file.\n\n"
         "If no text is provided on the command line, "
-        "reads the standard input.");
+        "reads the standard input.\n\n"
+        "In batch mode each input record is encoded separately, "
+        "PNG is the file\nname template where %d (e.g. %04d) "
+        "is replaced with the record number.\nWith --sheet all records "
+        "go to a single image, PNG is its file name.");
     ok = g_option_context_parse(options, &argc, &argv, &error);
+    save.scale = scale;
+    save.border = border;
+    save.compress = COMPRESS_DEFAULT;
+    if (ok && compress && !parse_compress_mode(compress, &save.compress)) {
+        error = g_error_new(G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+            "Invalid compression mode \'%s\'", compress);
+        ok = FALSE;
+    }
+    if (ok && batch && !tool_batch_parse_format(batch, &format)) {
+        error = g_error_new(G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+            "Invalid batch format '%s'", batch);
+        ok = FALSE;
+    }
+
+    if (ok && format && sheet > 0 && scale > 0 && border >= 0 && jobs >= 0 &&
+        argc == 2) {
+        GBytes* bytes = tool_read_input(file, &error);
+
+        if (bytes) {
+            GArray* items = tool_batch_split(bytes, format, errcorr, &error);
 
-    if (ok && scale > 0 && border >= 0 && (argc == 2 || (argc == 3 && !file))) {
+            if (items) {
+                if (tool_batch_sheet(items, 0, argv[1], jobs, sheet,
+                    AZTEC_PIXEL_MONO_MSB, scale, border, save_batch_sheet,
+                    &save)) {
+                    ret = RET_OK;
+                }
+                g_array_free(items, TRUE);
+            } else {
+                errmsg("%s\n", error->message);
+                g_error_free(error);
+            }
+            g_bytes_unref(bytes);
+        } else {
+            errmsg("%s\n", error->message);
+            g_error_free(error);
+        }
+    } else if (ok && format && !sheet && scale > 0 && border >= 0 &&
+        jobs >= 0 && argc == 2) {
+        const char* templ = argv[1];
+        char* test = tool_batch_filename(templ, 1);
+
+        if (test || !strcmp(templ, "-")) {
+            GBytes* bytes = tool_read_input(file, &error);
+
+            if (bytes) {
+                GArray* items = tool_batch_split(bytes, format, errcorr,
+                    &error);
+
+                if (items) {
+                    if (tool_batch_run(items, 0, templ, jobs,
+                        save_batch_symbol, &save)) {
+                        ret = RET_OK;
+                    }
+                    g_array_free(items, TRUE);
+                } else {
+                    errmsg("%s\n", error->message);
+                    g_error_free(error);
+                }
+                g_bytes_unref(bytes);
+            } else {
+                errmsg("%s\n", error->message);
+                g_error_free(error);
+            }
+        } else {
+            errmsg("Invalid file name template '%s'\n", templ);
+            ret = RET_CMDLINE;
+        }
+        g_free(test);
+    } else if (ok && !format && !sheet && scale > 0 && border >= 0 &&
+        (argc == 2 || (argc == 3 && !file))) {
         const char* png = argv[argc - 1];
         const void* data = NULL;
         gsize size;
         GBytes* bytes = NULL;
 
-        if (argc == 2 && (!file || !strcmp(file, "-"))) {
-            GByteArray* buf = g_byte_array_new();
-            int c;
-
-            /* Read stdin until EOF */
-            while ((c = getchar()) != EOF) {
-                const guint8 byte = (guint8)c;
-
-                g_byte_array_append(buf, &byte, 1);
-            }
-            bytes = g_byte_array_free_to_bytes(buf);
-        } else if (file) {
-            GMappedFile* map = g_mapped_file_new(file, FALSE, &error);
-
-            if (map) {
-                const void* contents = g_mapped_file_get_contents(map);
-                const gsize length = g_mapped_file_get_length(map);
-
-                bytes = g_bytes_new_with_free_func(contents, length,
-                    (GDestroyNotify)g_mapped_file_unref, map);
-            } else {
+        if (argc == 2) {
+            bytes = tool_read_input(file, &error);
+            if (!bytes) {
                 errmsg("%s\n", error->message);
                 g_error_free(error);
             }
@@ -252,7 +395,7 @@ main(
                     }
 
                     if (out) {
-                        ret = save_symbol(symbol, scale, border, out);
+                        ret = save_symbol(symbol, &save, out);
                         if (f) {
                             fclose(f);
                         }
@@ -279,6 +422,9 @@ main(
         }
         ret = RET_CMDLINE;
     }
+    if (stats && ret != RET_CMDLINE) {
+        tool_stats_print(stderr);
+    }
     g_option_context_free(options);
     return ret;
 }
@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+# Compares PNG compression modes of aztec-png. Encodes the same batch of
+# records with each mode on a single thread and prints the elapsed time
+# and the total output size.
+#
+# Usage: bench.sh [COUNT [SCALE]]
+#
+
+COUNT=${1:-2000}
+SCALE=${2:-4}
+DIR=`dirname $0`
+EXE=${AZTEC_PNG:-$DIR/build/release/aztec-png}
+INPUT=`mktemp`
+OUTPUT=`mktemp`
+trap 'rm -f "$INPUT" "$OUTPUT"' EXIT
+
+if [ ! -x "$EXE" ] ; then
+    echo "$EXE not found, run make first" 1>&2
+    exit 1
+fi
+
+# Deterministic records of various lengths
+awk -v n="$COUNT" 'BEGIN {
+    for (i = 0; i < n; i++) {
+        s = sprintf("M1PASSENGER/RECORD %06d E%07d ", i, i * 7919);
+        for (j = 0; j < i % 8; j++) s = s s;
+        print substr(s, 1, 20 + (i * 37) % 600);
+    }
+}' > "$INPUT"
+
+printf "%-8s %10s %12s\n" MODE SECONDS BYTES
+for mode in default fast none rows ; do
+    start=`date +%s.%N`
+    "$EXE" -B lines -j 1 -s "$SCALE" -z $mode -f "$INPUT" - > "$OUTPUT" || exit
+    end=`date +%s.%N`
+    awk -v m=$mode -v t="$end - $start" -v b=`wc -c < "$OUTPUT"` 'BEGIN {
+        split(t, a, " - "); printf "%-8s %10.3f %12d\n", m, a[1] - a[2], b
+    }'
+done
@@ -0,0 +1,575 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "rows_png.h"
+
+#include <zlib.h>
+#include <string.h>
+
+#define ROWS_LITLEN_CODES 286
+#define ROWS_DIST_CODES 30
+#define ROWS_MATCH (0x80000000)
+
+typedef struct rows_writer {
+    GArray* tokens;     /* Literals and ROWS_MATCH|len<<16|(dist-1) */
+    guint32 litlen_freq[ROWS_LITLEN_CODES];
+    guint32 dist_freq[ROWS_DIST_CODES];
+    guint8* row;        /* Filter byte followed by the pixels */
+    guint8* prev;       /* Previous row */
+    gboolean have_prev;
+    guint n;            /* Bytes per row, including the filter byte */
+    uLong adler;
+    GByteArray* data;   /* Contents of the IDAT chunk */
+    guint32 bits;
+    guint nbits;
+} RowsWriter;
+
+typedef struct rows_code {
+    guint16 code;
+    guint8 len;
+} RowsCode;
+
+static const guint16 rows_len_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const guint8 rows_len_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const guint16 rows_dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+static const guint8 rows_dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static
+guint
+rows_png_len_code(
+    guint len)
+{
+    guint lc = G_N_ELEMENTS(rows_len_base) - 1;
+
+    while (rows_len_base[lc] > len) {
+        lc--;
+    }
+    return lc;
+}
+
+static
+guint
+rows_png_dist_code(
+    guint dist)
+{
+    guint dc = G_N_ELEMENTS(rows_dist_base) - 1;
+
+    while (rows_dist_base[dc] > dist) {
+        dc--;
+    }
+    return dc;
+}
+
+static
+void
+rows_png_literal(
+    RowsWriter* w,
+    guint8 lit)
+{
+    const guint32 token = lit;
+
+    g_array_append_val(w->tokens, token);
+    w->litlen_freq[lit]++;
+}
+
+static
+void
+rows_png_copy(
+    RowsWriter* w,
+    gsize len,
+    guint dist)
+{
+    /* Long copies are split into matches of 3..258 bytes */
+    while (len) {
+        guint32 token;
+        guint n = MIN(len, 258);
+
+        if (len > n && len - n < 3) {
+            n = len - 3;
+        }
+        token = ROWS_MATCH | (n << 16) | (dist - 1);
+        g_array_append_val(w->tokens, token);
+        w->litlen_freq[257 + rows_png_len_code(n)]++;
+        w->dist_freq[rows_png_dist_code(dist)]++;
+        len -= n;
+    }
+}
+
+static
+gboolean
+rows_png_row(
+    const guint8* row,
+    gsize rowsize,
+    guint repeat,
+    gpointer user_data)
+{
+    RowsWriter* w = user_data;
+    guint8* cur = w->row;
+    const guint8* prev = w->prev;
+    const guint n = w->n;
+    uLong adler;
+    guint i;
+
+    /* Filter type None, then the pixels (in PNG 0 is black) */
+    for (i = 0; i < rowsize; i++) {
+        cur[i + 1] = ~row[i];
+    }
+
+    /*
+     * Bilevel rows mostly consist of runs of identical bytes and of
+     * spans identical to the row above, so each byte is either copied
+     * from the previous byte, copied from the previous row or stored
+     * as a literal, whichever covers more.
+     */
+    for (i = 0; i < n;) {
+        guint up = 0, run = 0;
+
+        if (w->have_prev) {
+            const guint8 last = i ? cur[i - 1] : prev[n - 1];
+
+            while (i + up < n && cur[i + up] == prev[i + up]) {
+                up++;
+            }
+            while (i + run < n && cur[i + run] == last) {
+                run++;
+            }
+        } else if (i) {
+            while (i + run < n && cur[i + run] == cur[i - 1]) {
+                run++;
+            }
+        }
+
+        if (up >= 3 && up >= run) {
+            rows_png_copy(w, up, n);
+            i += up;
+        } else if (run >= 3) {
+            rows_png_copy(w, run, 1);
+            i += run;
+        } else {
+            rows_png_literal(w, cur[i++]);
+        }
+    }
+
+    /* The replicas are copies of the row we have just coded */
+    if (repeat > 1) {
+        rows_png_copy(w, (gsize)n * (repeat - 1), n);
+    }
+
+    adler = adler32(1, cur, n);
+    for (i = 0; i < repeat; i++) {
+        w->adler = adler32_combine(w->adler, adler, n);
+    }
+
+    w->row = w->prev;
+    w->prev = cur;
+    w->have_prev = TRUE;
+    return TRUE;
+}
+
+static
+int
+rows_png_compare_leaves(
+    const void* a,
+    const void* b,
+    gpointer freq)
+{
+    const guint32* f = freq;
+    const guint16 i = *(const guint16*)a;
+    const guint16 j = *(const guint16*)b;
+
+    return (f[i] < f[j]) ? -1 : (f[i] > f[j]) ? 1 : ((int)i - (int)j);
+}
+
+/*
+ * Computes Huffman code lengths not exceeding the limit. If the tree
+ * gets too deep, the frequencies are flattened and it's built again.
+ */
+static
+void
+rows_png_code_lengths(
+    const guint32* freq,
+    guint count,
+    guint limit,
+    guint8* lengths)
+{
+    guint32 f[2 * ROWS_LITLEN_CODES];
+    guint16 parent[2 * ROWS_LITLEN_CODES];
+    guint16 leaves[ROWS_LITLEN_CODES];
+    guint16 nodes[ROWS_LITLEN_CODES];
+    guint i, nleaves = 0;
+
+    memcpy(f, freq, sizeof(f[0]) * count);
+    memset(lengths, 0, count);
+    for (i = 0; i < count; i++) {
+        if (f[i]) {
+            leaves[nleaves++] = i;
+        }
+    }
+
+    /* Callers make sure there are at least two symbols */
+    for (;;) {
+        guint li = 0, ni = 0, nn = 0, next = count, maxlen = 0;
+
+        g_qsort_with_data(leaves, nleaves, sizeof(leaves[0]),
+            rows_png_compare_leaves, f);
+
+        /* Two queues, the merged nodes come out sorted by themselves */
+        while ((nleaves - li) + (nn - ni) > 1) {
+            guint16 pick[2];
+            guint k;
+
+            for (k = 0; k < 2; k++) {
+                if (li < nleaves && (ni == nn ||
+                    f[leaves[li]] <= f[nodes[ni]])) {
+                    pick[k] = leaves[li++];
+                } else {
+                    pick[k] = nodes[ni++];
+                }
+            }
+            f[next] = f[pick[0]] + f[pick[1]];
+            parent[pick[0]] = parent[pick[1]] = next;
+            nodes[nn++] = next++;
+        }
+
+        for (i = 0; i < nleaves; i++) {
+            guint16 node = leaves[i];
+            guint len = 0;
+
+            while (node != next - 1) {
+                node = parent[node];
+                len++;
+            }
+            lengths[leaves[i]] = len;
+            maxlen = MAX(maxlen, len);
+        }
+
+        if (maxlen <= limit) {
+            break;
+        }
+        for (i = 0; i < nleaves; i++) {
+            f[leaves[i]] = (f[leaves[i]] >> 1) | 1;
+        }
+    }
+}
+
+static
+void
+rows_png_make_codes(
+    const guint8* lengths,
+    guint count,
+    RowsCode* codes)
+{
+    /* Canonical Huffman codes, RFC 1951 section 3.2.2 */
+    guint16 bl_count[16], next_code[16];
+    guint i, code = 0;
+
+    memset(bl_count, 0, sizeof(bl_count));
+    for (i = 0; i < count; i++) {
+        bl_count[lengths[i]]++;
+    }
+    bl_count[0] = 0;
+    for (i = 1; i < 16; i++) {
+        code = (code + bl_count[i - 1]) << 1;
+        next_code[i] = code;
+    }
+    for (i = 0; i < count; i++) {
+        codes[i].len = lengths[i];
+        codes[i].code = lengths[i] ? next_code[lengths[i]]++ : 0;
+    }
+}
+
+static
+void
+rows_png_put_bits(
+    RowsWriter* w,
+    guint32 value,
+    guint count)
+{
+    /* Deflate packs bits starting with the least significant one */
+    w->bits |= value << w->nbits;
+    w->nbits += count;
+    while (w->nbits >= 8) {
+        const guint8 byte = (guint8)w->bits;
+
+        g_byte_array_append(w->data, &byte, 1);
+        w->bits >>= 8;
+        w->nbits -= 8;
+    }
+}
+
+static
+void
+rows_png_put_code(
+    RowsWriter* w,
+    const RowsCode* code)
+{
+    /* Huffman codes are packed starting with the most significant bit */
+    guint32 rev = 0;
+    guint i;
+
+    for (i = 0; i < code->len; i++) {
+        rev = (rev << 1) | ((code->code >> i) & 1);
+    }
+    rows_png_put_bits(w, rev, code->len);
+}
+
+static
+void
+rows_png_write_block(
+    RowsWriter* w)
+{
+    static const guint8 cl_order[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+    };
+    guint8 lengths[ROWS_LITLEN_CODES + ROWS_DIST_CODES];
+    guint8 cl_lengths[19];
+    guint32 cl_freq[19];
+    guint8 cl_syms[ROWS_LITLEN_CODES + ROWS_DIST_CODES];
+    guint8 cl_extra[ROWS_LITLEN_CODES + ROWS_DIST_CODES];
+    RowsCode litlen[ROWS_LITLEN_CODES];
+    RowsCode dist[ROWS_DIST_CODES];
+    RowsCode cl[19];
+    guint i, j, nlit, ndist, ncl, nsyms = 0, total;
+
+    /* End of block, plus make sure that each tree has two leaves */
+    w->litlen_freq[256]++;
+    if (!w->litlen_freq[0]) {
+        w->litlen_freq[0] = 1;
+    }
+    if (!w->dist_freq[0]) {
+        w->dist_freq[0] = 1;
+    }
+    if (!w->dist_freq[1]) {
+        w->dist_freq[1] = 1;
+    }
+
+    rows_png_code_lengths(w->litlen_freq, ROWS_LITLEN_CODES, 15, lengths);
+    rows_png_code_lengths(w->dist_freq, ROWS_DIST_CODES, 15,
+        lengths + ROWS_LITLEN_CODES);
+    rows_png_make_codes(lengths, ROWS_LITLEN_CODES, litlen);
+    rows_png_make_codes(lengths + ROWS_LITLEN_CODES, ROWS_DIST_CODES, dist);
+
+    for (nlit = ROWS_LITLEN_CODES; !lengths[nlit - 1]; nlit--);
+    for (ndist = ROWS_DIST_CODES; !lengths[ROWS_LITLEN_CODES + ndist - 1];
+        ndist--);
+
+    /* Code lengths of both trees back to back, zeros run-length coded */
+    memmove(lengths + nlit, lengths + ROWS_LITLEN_CODES, ndist);
+    total = nlit + ndist;
+    memset(cl_freq, 0, sizeof(cl_freq));
+    for (i = 0; i < total; i = j) {
+        for (j = i + 1; j < total && !lengths[i] && !lengths[j] &&
+            j - i < 138; j++);
+        if (j - i >= 11) {
+            cl_syms[nsyms] = 18;
+            cl_extra[nsyms++] = j - i - 11;
+        } else if (j - i >= 3) {
+            cl_syms[nsyms] = 17;
+            cl_extra[nsyms++] = j - i - 3;
+        } else {
+            j = i + 1;
+            cl_syms[nsyms++] = lengths[i];
+        }
+        cl_freq[cl_syms[nsyms - 1]]++;
+    }
+    for (i = 0, j = 0; i < 19; i++) {
+        j += (cl_freq[i] != 0);
+    }
+    if (j < 2) {
+        cl_freq[cl_freq[0] ? 1 : 0] = 1;
+    }
+    rows_png_code_lengths(cl_freq, 19, 7, cl_lengths);
+    rows_png_make_codes(cl_lengths, 19, cl);
+    for (ncl = 19; !cl_lengths[cl_order[ncl - 1]]; ncl--);
+
+    /* Header */
+    rows_png_put_bits(w, 5, 3); /* Final block, dynamic codes */
+    rows_png_put_bits(w, nlit - 257, 5);
+    rows_png_put_bits(w, ndist - 1, 5);
+    rows_png_put_bits(w, ncl - 4, 4);
+    for (i = 0; i < ncl; i++) {
+        rows_png_put_bits(w, cl_lengths[cl_order[i]], 3);
+    }
+    for (i = 0; i < nsyms; i++) {
+        rows_png_put_code(w, cl + cl_syms[i]);
+        if (cl_syms[i] == 17) {
+            rows_png_put_bits(w, cl_extra[i], 3);
+        } else if (cl_syms[i] == 18) {
+            rows_png_put_bits(w, cl_extra[i], 7);
+        }
+    }
+
+    /* Data */
+    for (i = 0; i < w->tokens->len; i++) {
+        const guint32 token = g_array_index(w->tokens, guint32, i);
+
+        if (token & ROWS_MATCH) {
+            const guint len = (token >> 16) & 0x1ff;
+            const guint d = (token & 0xffff) + 1;
+            const guint lc = rows_png_len_code(len);
+            const guint dc = rows_png_dist_code(d);
+
+            rows_png_put_code(w, litlen + 257 + lc);
+            rows_png_put_bits(w, len - rows_len_base[lc],
+                rows_len_extra[lc]);
+            rows_png_put_code(w, dist + dc);
+            rows_png_put_bits(w, d - rows_dist_base[dc],
+                rows_dist_extra[dc]);
+        } else {
+            rows_png_put_code(w, litlen + token);
+        }
+    }
+    rows_png_put_code(w, litlen + 256);
+    if (w->nbits) {
+        rows_png_put_bits(w, 0, 8 - w->nbits);
+    }
+}
+
+static
+void
+rows_png_chunk(
+    const char* type,
+    const guint8* data,
+    guint len,
+    FILE* out)
+{
+    guint8 buf[4];
+    uLong crc = crc32(0, (const Bytef*)type, 4);
+
+    if (len) {
+        crc = crc32(crc, data, len);
+    }
+    buf[0] = (guint8)(len >> 24);
+    buf[1] = (guint8)(len >> 16);
+    buf[2] = (guint8)(len >> 8);
+    buf[3] = (guint8)len;
+    fwrite(buf, 1, 4, out);
+    fwrite(type, 1, 4, out);
+    fwrite(data, 1, len, out);
+    buf[0] = (guint8)(crc >> 24);
+    buf[1] = (guint8)(crc >> 16);
+    buf[2] = (guint8)(crc >> 8);
+    buf[3] = (guint8)crc;
+    fwrite(buf, 1, 4, out);
+}
+
+gboolean
+rows_png_save(
+    AztecRowReader* reader,
+    FILE* out)
+{
+    static const guint8 signature[8] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'
+    };
+    /* Deflate with 32K window, no preset dictionary, fastest algorithm */
+    static const guint8 zlib_header[2] = { 0x78, 0x01 };
+    const guint width = aztec_row_reader_width(reader);
+    const guint height = aztec_row_reader_height(reader);
+    const gsize rowsize = aztec_row_reader_rowsize(reader);
+    gboolean ok;
+    guint8 ihdr[13];
+    guint8 trailer[4];
+    RowsWriter* w = g_new0(RowsWriter, 1);
+    const guint8* row;
+    guint repeat;
+
+    w->n = rowsize + 1;
+    w->tokens = g_array_new(FALSE, FALSE, sizeof(guint32));
+    w->row = g_malloc0(w->n);
+    w->prev = g_malloc0(w->n);
+    w->adler = adler32(0, NULL, 0);
+    while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+        rows_png_row(row, rowsize, repeat, w);
+    }
+
+    w->data = g_byte_array_sized_new(w->tokens->len + 256);
+    g_byte_array_append(w->data, zlib_header, sizeof(zlib_header));
+    rows_png_write_block(w);
+    trailer[0] = (guint8)(w->adler >> 24);
+    trailer[1] = (guint8)(w->adler >> 16);
+    trailer[2] = (guint8)(w->adler >> 8);
+    trailer[3] = (guint8)w->adler;
+    g_byte_array_append(w->data, trailer, sizeof(trailer));
+
+    ihdr[0] = (guint8)(width >> 24);
+    ihdr[1] = (guint8)(width >> 16);
+    ihdr[2] = (guint8)(width >> 8);
+    ihdr[3] = (guint8)width;
+    ihdr[4] = (guint8)(height >> 24);
+    ihdr[5] = (guint8)(height >> 16);
+    ihdr[6] = (guint8)(height >> 8);
+    ihdr[7] = (guint8)height;
+    ihdr[8] = 1;    /* Bit depth */
+    ihdr[9] = 0;    /* Grayscale */
+    ihdr[10] = 0;   /* Deflate */
+    ihdr[11] = 0;   /* Adaptive filtering */
+    ihdr[12] = 0;   /* No interlace */
+
+    fwrite(signature, 1, sizeof(signature), out);
+    rows_png_chunk("IHDR", ihdr, sizeof(ihdr), out);
+    rows_png_chunk("IDAT", w->data->data, w->data->len, out);
+    rows_png_chunk("IEND", NULL, 0, out);
+    ok = !ferror(out);
+
+    g_byte_array_unref(w->data);
+    g_array_free(w->tokens, TRUE);
+    g_free(w->row);
+    g_free(w->prev);
+    g_free(w);
+    return ok;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_print.h"
+#include "tool_batch.h"
+#include "tool_stats.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define RET_OK 0
+#define RET_ERR 1
+#define RET_CMDLINE 2
+
+typedef enum printer_format {
+    PRINTER_FORMAT_HEX,
+    PRINTER_FORMAT_ACS,
+    PRINTER_FORMAT_Z64,
+    PRINTER_FORMAT_ESCPOS
+} PRINTER_FORMAT;
+
+static const char* printer_formats[] = {
+    "hex", "acs", "z64", "escpos"
+};
+
+typedef struct app_options {
+    int scale;
+    int border;
+    int band;
+    gboolean label;
+    PRINTER_FORMAT format;
+} AppOptions;
+
+static
+G_GNUC_PRINTF(1,2)
+void
+errmsg(
+    const char* format,
+    ...)
+{
+    va_list va;
+    va_start(va, format);
+    vfprintf(stderr, format, va);
+    va_end(va);
+}
+
+static
+int
+save_symbol(
+    const AztecSymbol* symbol,
+    const AppOptions* opts,
+    FILE* out)
+{
+    if (opts->format == PRINTER_FORMAT_ESCPOS) {
+        GBytes* data = aztec_symbol_escpos(symbol, opts->scale, opts->border,
+            opts->band);
+        gsize size;
+        const void* bytes = g_bytes_get_data(data, &size);
+
+        fwrite(bytes, 1, size, out);
+        g_bytes_unref(data);
+    } else {
+        char* gf = aztec_symbol_zpl(symbol, (opts->format ==
+            PRINTER_FORMAT_HEX) ? AZTEC_ZPL_HEX : (opts->format ==
+            PRINTER_FORMAT_ACS) ? AZTEC_ZPL_ACS : AZTEC_ZPL_Z64,
+            opts->scale, opts->border);
+
+        if (!gf) {
+            return RET_ERR;
+        }
+        if (opts->label) {
+            fprintf(out, "^XA\n^FO0,0%s^FS\n^XZ\n", gf);
+        } else {
+            fputs(gf, out);
+            fputc('\n', out);
+        }
+        g_free(gf);
+    }
+    return ferror(out) ? RET_ERR : RET_OK;
+}
+
+static
+gboolean
+save_batch_symbol(
+    const AztecSymbol* symbol,
+    FILE* out,
+    gpointer opts)
+{
+    return save_symbol(symbol, opts, out) == RET_OK;
+}
+
+static
+gboolean
+parse_format(
+    const char* value,
+    PRINTER_FORMAT* format)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(printer_formats); i++) {
+        if (!g_ascii_strcasecmp(value, printer_formats[i])) {
+            *format = (PRINTER_FORMAT)i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+int
+main(
+    int argc,
+    char* argv[])
+{
+    int ret = RET_ERR;
+    int errcorr = AZTEC_CORRECTION_DEFAULT;
+    int jobs = 0;
+    const char* file = NULL;
+    const char* batch = NULL;
+    const char* format = NULL;
+    TOOL_BATCH_FORMAT batch_format = TOOL_BATCH_NONE;
+    gboolean ok;
+    gboolean stats = FALSE;
+    GError* error = NULL;
+    AppOptions opts;
+    GOptionContext* options;
+    GOptionEntry entries[] = {
+        { "scale", 's', 0, G_OPTION_ARG_INT, &opts.scale,
+          "Scale factor [1]", "SCALE" },
+        { "correction", 'c', 0, G_OPTION_ARG_INT, &errcorr,
+          "Error correction [23]", "PERCENT" },
+        { "border", 'b', 0, G_OPTION_ARG_INT, &opts.border,
+          "Border around the symbol [1]", "PIXELS" },
+        { "format", 'F', 0, G_OPTION_ARG_STRING, &format,
+          "Output format (hex, acs, z64 or escpos) [acs]", "FORMAT" },
+        { "label", 'l', 0, G_OPTION_ARG_NONE, &opts.label,
+          "Wrap ZPL graphics into a complete label", NULL },
+        { "band", 'r', 0, G_OPTION_ARG_INT, &opts.band,
+          "Maximum rows per ESC/POS command [all]", "ROWS" },
+        { "file", 'f', 0, G_OPTION_ARG_FILENAME, &file,
+          "Encode data from FILE", "FILE" },
+        { "batch", 'B', 0, G_OPTION_ARG_STRING, &batch,
+          "Encode each record (lines, nul or length)", "FORMAT" },
+        { "jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+          "Number of batch threads [all CPUs]", "N" },
+        { "stats", 0, 0, G_OPTION_ARG_NONE, &stats,
+          "Print encoder statistics to stderr", NULL },
+        { NULL }
+    };
+
+    memset(&opts, 0, sizeof(opts));
+    opts.scale = 1;
+    opts.border = 1;
+    opts.format = PRINTER_FORMAT_ACS;
+    options = g_option_context_new("[TEXT] OUTPUT");
+    g_option_context_add_main_entries(options, entries, NULL);
+    g_option_context_set_summary(options,
+        "Generates Aztec symbol as ZPL or ESC/POS raster graphics.\n\n"
+        "If no text is provided on the command line, "
+        "reads the standard input.\n\n"
+        "In batch mode each input record is encoded separately, "
+        "OUTPUT is the file\nname template where %d (e.g. %04d) "
+        "is replaced with the record number.");
+    ok = g_option_context_parse(options, &argc, &argv, &error);
+    if (ok && format && !parse_format(format, &opts.format)) {
+        error = g_error_new(G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+            "Invalid output format \'%s\'", format);
+        ok = FALSE;
+    }
+    if (ok && batch && !tool_batch_parse_format(batch, &batch_format)) {
+        error = g_error_new(G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+            "Invalid batch format \'%s\'", batch);
+        ok = FALSE;
+    }
+
+    if (ok && batch_format && opts.scale > 0 && opts.border >= 0 &&
+        opts.band >= 0 && jobs >= 0 && argc == 2) {
+        const char* templ = argv[1];
+        char* test = tool_batch_filename(templ, 1);
+
+        if (test || !strcmp(templ, "-")) {
+            GBytes* bytes = tool_read_input(file, &error);
+
+            if (bytes) {
+                GArray* items = tool_batch_split(bytes, batch_format,
+                    errcorr, &error);
+
+                if (items) {
+                    if (tool_batch_run(items, 0, templ, jobs,
+                        save_batch_symbol, &opts)) {
+                        ret = RET_OK;
+                    }
+                    g_array_free(items, TRUE);
+                } else {
+                    errmsg("%s\n", error->message);
+                    g_error_free(error);
+                }
+                g_bytes_unref(bytes);
+            } else {
+                errmsg("%s\n", error->message);
+                g_error_free(error);
+            }
+        } else {
+            errmsg("Invalid file name template \'%s\'\n", templ);
+            ret = RET_CMDLINE;
+        }
+        g_free(test);
+    } else if (ok && !batch_format && opts.scale > 0 && opts.border >= 0 &&
+        opts.band >= 0 && (argc == 2 || (argc == 3 && !file))) {
+        const char* output = argv[argc - 1];
+        const void* data = NULL;
+        gsize size;
+        GBytes* bytes = NULL;
+
+        if (argc == 2) {
+            bytes = tool_read_input(file, &error);
+            if (!bytes) {
+                errmsg("%s\n", error->message);
+                g_error_free(error);
+            }
+        } else {
+            data = argv[1];
+            size = strlen(data);
+        }
+
+        if (bytes) {
+            data = g_bytes_get_data(bytes, &size);
+        }
+
+        if (data) {
+            if (size) {
+                AztecSymbol* symbol = aztec_encode(data, size, errcorr);
+
+                if (symbol) {
+                    FILE* f = NULL;
+                    FILE* out = NULL;
+
+                    if (!strcmp(output, "-")) {
+                        out = stdout;
+                    } else {
+                        out = f = fopen(output, "wb");
+                        if (!out) {
+                            errmsg("%s: %s\n", output, strerror(errno));
+                        }
+                    }
+
+                    if (out) {
+                        ret = save_symbol(symbol, &opts, out);
+                        if (f) {
+                            fclose(f);
+                        }
+                    }
+                    aztec_symbol_free(symbol);
+                } else {
+                    errmsg("Failed to generate symbol (too much data?)\n");
+                }
+            } else {
+                errmsg("Nothing to encode.\n");
+            }
+        }
+        if (bytes) {
+            g_bytes_unref(bytes);
+        }
+    } else {
+        if (error) {
+            errmsg("%s\n", error->message);
+            g_error_free(error);
+        } else {
+            char* help = g_option_context_get_help(options, TRUE, NULL);
+            errmsg("%s", help);
+            g_free(help);
+        }
+        ret = RET_CMDLINE;
+    }
+    if (stats && ret != RET_CMDLINE) {
+        tool_stats_print(stderr);
+    }
+    g_option_context_free(options);
+    return ret;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
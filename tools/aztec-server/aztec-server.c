@@ -0,0 +1,1089 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#define _GNU_SOURCE /* memfd_create, F_ADD_SEALS, ppoll, accept4 */
+
+#include "aztec_print.h"
+#include "aztec_render.h"
+#include "aztec_tiff.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#define RET_OK 0
+#define RET_ERR 1
+#define RET_CMDLINE 2
+
+/*
+ * Protocol. All numbers are big-endian. Each request is a frame:
+ *
+ *   u32 length of the rest of the frame (12 + payload length)
+ *   u32 request id, echoed in the reply
+ *   u8  operation (SERVER_OP)
+ *   u8  output format (SERVER_FORMAT)
+ *   u8  error correction percentage, zero for the default
+ *   u8  border (quiet zone) in modules
+ *   u16 scale, zero meaning one
+ *   u16 flags (SERVER_FLAG_MEMFD)
+ *   ... payload
+ *
+ * and each reply is:
+ *
+ *   u32 length of the rest of the frame (20 + inline data length)
+ *   u32 request id
+ *   u8  status (SERVER_STATUS)
+ *   u8  flags (SERVER_FLAG_MEMFD if the data is in the passed memfd)
+ *   u16 zero
+ *   u32 image width in pixels
+ *   u32 image height in pixels
+ *   u32 data size
+ *   ... data, unless it's been passed as a memfd
+ *
+ * Requests on a connection are handled in parallel, replies come in
+ * the order of completion and are matched to requests by id.
+ */
+#define SERVER_REQUEST_HEADER (12)
+#define SERVER_REPLY_HEADER (24)
+#define SERVER_MAX_PAYLOAD (64 * 1024)
+#define SERVER_MAX_IMAGE (256 * 1024 * 1024)
+
+typedef enum server_op {
+    SERVER_OP_ENCODE,
+    SERVER_OP_STATS     /* Plain text key value pairs */
+} SERVER_OP;
+
+typedef enum server_format {
+    SERVER_FORMAT_PBM,  /* P4, 1 bpp, MSB first, 1 is black */
+    SERVER_FORMAT_PGM,  /* P5, 8 bpp, 0 is black */
+    SERVER_FORMAT_RAW,  /* Same as P4 without the header */
+    SERVER_FORMAT_TIFF, /* Bilevel TIFF, CCITT Group 4 compression */
+    SERVER_FORMAT_ZPL,  /* ZPL ^GFA command, ACS compression */
+    SERVER_FORMAT_ESCPOS, /* ESC/POS GS v 0 raster image */
+    SERVER_FORMAT_COUNT
+} SERVER_FORMAT;
+
+typedef enum server_status {
+    SERVER_STATUS_OK,
+    SERVER_STATUS_BAD_REQUEST,
+    SERVER_STATUS_ENCODE_FAILED,    /* Too much data */
+    SERVER_STATUS_ERROR
+} SERVER_STATUS;
+
+#define SERVER_FLAG_MEMFD (0x01)
+
+/* Per connection limit of requests being handled */
+#define SERVER_MAX_INFLIGHT (256)
+#define SERVER_READ_BUF (64 * 1024)
+#define SERVER_SEND_TIMEOUT (10)
+/* Larger scratch buffers aren't kept by the worker threads */
+#define SERVER_SCRATCH_KEEP (1024 * 1024)
+
+/*
+ * Log-linear latency histogram in microseconds, 8 buckets per power
+ * of two (12% resolution). Values below 16 have their own buckets.
+ */
+#define SERVER_HIST_SUB_BITS (3)
+#define SERVER_HIST_SUB (1 << SERVER_HIST_SUB_BITS)
+#define SERVER_HIST_BUCKETS (256)
+
+typedef struct server_hist {
+    guint64 count[SERVER_HIST_BUCKETS];
+    guint64 max;
+} ServerHist;
+
+typedef struct server {
+    GThreadPool* pool;
+    ServerHist latency;     /* From reading the request to the reply */
+    ServerHist service;     /* Time spent by the worker */
+    guint64 requests;
+    guint64 failed;
+    guint64 connections;
+    GMutex mutex;
+    GCond cond;
+    GSList* conns;
+    gint active;
+} Server;
+
+typedef struct server_conn {
+    Server* server;
+    int fd;
+    gint refcount;
+    GMutex write_mutex;
+    GMutex mutex;
+    GCond cond;
+    guint inflight;
+    gsize rstart;
+    gsize rend;
+    guint8 rbuf[SERVER_READ_BUF];
+} ServerConn;
+
+typedef struct server_job {
+    ServerConn* conn;
+    gint64 start;
+    guint32 id;
+    guint8 op;
+    guint8 format;
+    guint8 correction;
+    guint8 border;
+    guint scale;
+    guint flags;
+    gsize len;
+    const guint8* payload;
+} ServerJob;
+
+typedef struct server_reply {
+    guint8 header[SERVER_REPLY_HEADER];
+    SERVER_STATUS status;
+    guint width;
+    guint height;
+    const void* data;
+    gsize size;
+    int memfd;
+} ServerReply;
+
+/* Each byte of a 1-bpp row expands into 8 gray pixels */
+static guint8 pgm_expand[256][8];
+static GPrivate server_scratch_key =
+    G_PRIVATE_INIT((GDestroyNotify)g_byte_array_unref);
+static volatile sig_atomic_t server_quit;
+
+static
+G_GNUC_PRINTF(1,2)
+void
+errmsg(
+    const char* format,
+    ...)
+{
+    va_list va;
+    va_start(va, format);
+    vfprintf(stderr, format, va);
+    va_end(va);
+}
+
+static
+void
+pgm_expand_init(
+    void)
+{
+    guint i, j;
+
+    for (i = 0; i < 256; i++) {
+        for (j = 0; j < 8; j++) {
+            pgm_expand[i][j] = (i & (0x80 >> j)) ? 0 : 255;
+        }
+    }
+}
+
+static
+guint32
+server_get32(
+    const guint8* ptr)
+{
+    return ((guint32)ptr[0] << 24) | ((guint32)ptr[1] << 16) |
+        ((guint32)ptr[2] << 8) | ptr[3];
+}
+
+static
+void
+server_put32(
+    guint8* ptr,
+    guint32 value)
+{
+    ptr[0] = (guint8)(value >> 24);
+    ptr[1] = (guint8)(value >> 16);
+    ptr[2] = (guint8)(value >> 8);
+    ptr[3] = (guint8)value;
+}
+
+static
+guint
+server_hist_index(
+    guint64 us)
+{
+    if (us < 2 * SERVER_HIST_SUB) {
+        return (guint)us;
+    } else {
+        const guint msb = g_bit_nth_msf((gulong)MIN(us, G_MAXUINT32), -1);
+        const guint shift = msb - SERVER_HIST_SUB_BITS;
+
+        return MIN((shift + 1) * SERVER_HIST_SUB +
+            ((us >> shift) & (SERVER_HIST_SUB - 1)), SERVER_HIST_BUCKETS - 1);
+    }
+}
+
+/* The largest value falling into the bucket */
+static
+guint64
+server_hist_upper(
+    guint i)
+{
+    if (i < 2 * SERVER_HIST_SUB) {
+        return i;
+    } else {
+        const guint shift = i / SERVER_HIST_SUB - 1;
+
+        return ((guint64)(SERVER_HIST_SUB + i % SERVER_HIST_SUB + 1) <<
+            shift) - 1;
+    }
+}
+
+static
+void
+server_hist_add(
+    ServerHist* hist,
+    guint64 us)
+{
+    guint64 max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+
+    __atomic_fetch_add(hist->count + server_hist_index(us), 1,
+        __ATOMIC_RELAXED);
+    while (us > max && !__atomic_compare_exchange_n(&hist->max, &max, us,
+        TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+static
+void
+server_hist_snapshot(
+    const ServerHist* hist,
+    ServerHist* copy)
+{
+    guint i;
+
+    for (i = 0; i < SERVER_HIST_BUCKETS; i++) {
+        copy->count[i] = __atomic_load_n(hist->count + i, __ATOMIC_RELAXED);
+    }
+    copy->max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+}
+
+static
+guint64
+server_hist_percentile(
+    const ServerHist* hist,
+    guint permille)
+{
+    guint64 total = 0, sum = 0, rank;
+    guint i;
+
+    for (i = 0; i < SERVER_HIST_BUCKETS; i++) {
+        total += hist->count[i];
+    }
+    rank = (total * permille + 999) / 1000;
+    for (i = 0; i < SERVER_HIST_BUCKETS && total; i++) {
+        sum += hist->count[i];
+        if (sum >= rank) {
+            return MIN(server_hist_upper(i), hist->max);
+        }
+    }
+    return 0;
+}
+
+static
+void
+server_hist_print(
+    GString* buf,
+    const char* name,
+    const ServerHist* live)
+{
+    ServerHist hist;
+    guint i;
+
+    server_hist_snapshot(live, &hist);
+    g_string_append_printf(buf, "%s_p50_us %" G_GUINT64_FORMAT "\n"
+        "%s_p90_us %" G_GUINT64_FORMAT "\n"
+        "%s_p99_us %" G_GUINT64_FORMAT "\n"
+        "%s_p999_us %" G_GUINT64_FORMAT "\n"
+        "%s_max_us %" G_GUINT64_FORMAT "\n",
+        name, server_hist_percentile(&hist, 500),
+        name, server_hist_percentile(&hist, 900),
+        name, server_hist_percentile(&hist, 990),
+        name, server_hist_percentile(&hist, 999),
+        name, hist.max);
+
+    /* Non-empty buckets as upper bound:count pairs */
+    g_string_append_printf(buf, "%s_hist_us", name);
+    for (i = 0; i < SERVER_HIST_BUCKETS; i++) {
+        if (hist.count[i]) {
+            g_string_append_printf(buf, " %" G_GUINT64_FORMAT ":%"
+                G_GUINT64_FORMAT, server_hist_upper(i), hist.count[i]);
+        }
+    }
+    g_string_append_c(buf, '\n');
+}
+
+static const char* const server_stage_names[] = {
+    "segment", "config", "stuff", "rs", "mode", "place", "export"
+};
+G_STATIC_ASSERT(G_N_ELEMENTS(server_stage_names) == AZTEC_STAGE_COUNT);
+
+static
+GString*
+server_stats(
+    Server* server)
+{
+    GString* buf = g_string_sized_new(1024);
+    AztecCacheStats cache;
+    AztecStats encoder;
+
+    aztec_cache_get_stats(&cache);
+    g_string_append_printf(buf, "requests %" G_GUINT64_FORMAT "\n"
+        "failed %" G_GUINT64_FORMAT "\n"
+        "connections %" G_GUINT64_FORMAT "\n"
+        "active %d\n"
+        "cache_hits %" G_GUINT64_FORMAT "\n"
+        "cache_misses %" G_GUINT64_FORMAT "\n",
+        __atomic_load_n(&server->requests, __ATOMIC_RELAXED),
+        __atomic_load_n(&server->failed, __ATOMIC_RELAXED),
+        __atomic_load_n(&server->connections, __ATOMIC_RELAXED),
+        g_atomic_int_get(&server->active), cache.hits, cache.misses);
+    server_hist_print(buf, "latency", &server->latency);
+    server_hist_print(buf, "service", &server->service);
+
+    /* Only if libaztec was built with AZTEC_STATS=1 */
+    if (aztec_stats_snapshot(&encoder)) {
+        guint i;
+
+        g_string_append_printf(buf, "encoder_encodes %" G_GUINT64_FORMAT "\n"
+            "encoder_bytes %" G_GUINT64_FORMAT "\n"
+            "encoder_blocks %" G_GUINT64_FORMAT "\n"
+            "encoder_latches %" G_GUINT64_FORMAT "\n"
+            "encoder_shifts %" G_GUINT64_FORMAT "\n"
+            "encoder_stuffing_rounds %" G_GUINT64_FORMAT "\n"
+            "encoder_stuffed_bits %" G_GUINT64_FORMAT "\n"
+            "encoder_config_picks %" G_GUINT64_FORMAT "\n"
+            "encoder_config_iterations %" G_GUINT64_FORMAT "\n"
+            "encoder_codewords %" G_GUINT64_FORMAT "\n",
+            encoder.encodes, encoder.bytes, encoder.blocks, encoder.latches,
+            encoder.shifts, encoder.stuffing_rounds, encoder.stuffed_bits,
+            encoder.config_picks, encoder.config_iterations,
+            encoder.codewords);
+        for (i = 0; i < AZTEC_STAGE_COUNT; i++) {
+            g_string_append_printf(buf, "encoder_%s_ns %" G_GUINT64_FORMAT
+                "\n", server_stage_names[i], encoder.ns[i]);
+        }
+    }
+    return buf;
+}
+
+static
+void
+server_conn_unref(
+    ServerConn* conn)
+{
+    if (g_atomic_int_dec_and_test(&conn->refcount)) {
+        Server* server = conn->server;
+
+        g_mutex_lock(&server->mutex);
+        server->conns = g_slist_remove(server->conns, conn);
+        server->active--;
+        close(conn->fd);
+        g_cond_broadcast(&server->cond);
+        g_mutex_unlock(&server->mutex);
+        g_mutex_clear(&conn->write_mutex);
+        g_mutex_clear(&conn->mutex);
+        g_cond_clear(&conn->cond);
+        g_free(conn);
+    }
+}
+
+static
+gboolean
+server_conn_send(
+    ServerConn* conn,
+    struct iovec* iov,
+    int count,
+    int fd)
+{
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } cmsg;
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    if (fd >= 0) {
+        struct cmsghdr* hdr;
+
+        memset(&cmsg, 0, sizeof(cmsg));
+        msg.msg_control = cmsg.buf;
+        msg.msg_controllen = sizeof(cmsg.buf);
+        hdr = CMSG_FIRSTHDR(&msg);
+        hdr->cmsg_level = SOL_SOCKET;
+        hdr->cmsg_type = SCM_RIGHTS;
+        hdr->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(hdr), &fd, sizeof(int));
+    }
+
+    while (count > 0) {
+        ssize_t sent;
+
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        sent = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno != EINTR) {
+                return FALSE;
+            }
+        } else {
+            /* The descriptor goes with the first chunk */
+            msg.msg_control = NULL;
+            msg.msg_controllen = 0;
+            while (count > 0 && (gsize)sent >= iov->iov_len) {
+                sent -= iov->iov_len;
+                iov++;
+                count--;
+            }
+            if (count > 0) {
+                iov->iov_base = (char*)iov->iov_base + sent;
+                iov->iov_len -= sent;
+            }
+        }
+    }
+    return TRUE;
+}
+
+static
+guint8*
+server_scratch(
+    gsize size)
+{
+    GByteArray* scratch = g_private_get(&server_scratch_key);
+
+    if (!scratch || (size <= SERVER_SCRATCH_KEEP &&
+        scratch->len > SERVER_SCRATCH_KEEP)) {
+        scratch = g_byte_array_sized_new(MAX(size, 4096));
+        g_private_replace(&server_scratch_key, scratch);
+    }
+    g_byte_array_set_size(scratch, size);
+    return scratch->data;
+}
+
+static
+guint8*
+server_memfd(
+    gsize size,
+    int* fd)
+{
+    *fd = memfd_create("aztec", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (*fd >= 0) {
+        if (!ftruncate(*fd, size)) {
+            void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                *fd, 0);
+
+            if (map != MAP_FAILED) {
+                return map;
+            }
+        }
+        close(*fd);
+        *fd = -1;
+    }
+    return NULL;
+}
+
+static
+gboolean
+server_memfd_seal(
+    void* map,
+    gsize size,
+    int fd)
+{
+    /* The client gets an immutable buffer */
+    munmap(map, size);
+    return !fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW |
+        F_SEAL_WRITE | F_SEAL_SEAL);
+}
+
+/* Allocates the reply buffer, in the scratch area or in a memfd */
+static
+guint8*
+server_reply_alloc(
+    const ServerJob* job,
+    ServerReply* reply,
+    gsize size)
+{
+    if (job->flags & SERVER_FLAG_MEMFD) {
+        return server_memfd(size, &reply->memfd);
+    } else {
+        return server_scratch(size);
+    }
+}
+
+static
+gboolean
+server_reply_copy(
+    const ServerJob* job,
+    ServerReply* reply,
+    const void* data,
+    gsize size)
+{
+    if (job->flags & SERVER_FLAG_MEMFD) {
+        guint8* map = server_reply_alloc(job, reply, size);
+
+        if (!map) {
+            return FALSE;
+        }
+        memcpy(map, data, size);
+        reply->size = size;
+        return server_memfd_seal(map, size, reply->memfd);
+    } else {
+        reply->data = data;
+        reply->size = size;
+        return TRUE;
+    }
+}
+
+/* Renders PBM, PGM or raw bitmap straight into the reply buffer */
+static
+gboolean
+server_render(
+    const ServerJob* job,
+    ServerReply* reply,
+    const AztecSymbol* symbol)
+{
+    AztecRowReader* reader = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, job->scale, job->border);
+    const gsize rowsize = aztec_row_reader_rowsize(reader);
+    const guint width = reply->width;
+    const gsize linesize = (job->format == SERVER_FORMAT_PGM) ? width :
+        rowsize;
+    char header[32];
+    gsize hlen = 0;
+    guint8* buf;
+    const guint8* row;
+    guint repeat;
+
+    if (job->format == SERVER_FORMAT_PBM) {
+        hlen = g_snprintf(header, sizeof(header), "P4\n%u %u\n", width,
+            reply->height);
+    } else if (job->format == SERVER_FORMAT_PGM) {
+        hlen = g_snprintf(header, sizeof(header), "P5\n%u %u\n255\n",
+            width, reply->height);
+    }
+
+    reply->size = hlen + linesize * reply->height;
+    buf = server_reply_alloc(job, reply, reply->size);
+    if (buf) {
+        guint8* out = buf + hlen;
+
+        memcpy(buf, header, hlen);
+        while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+            guint8* line = out;
+            guint i;
+
+            if (job->format == SERVER_FORMAT_PGM) {
+                for (i = 0; i < width / 8; i++) {
+                    memcpy(out + 8 * i, pgm_expand[row[i]], 8);
+                }
+                if (width % 8) {
+                    memcpy(out + 8 * i, pgm_expand[row[i]], width % 8);
+                }
+            } else {
+                memcpy(out, row, rowsize);
+            }
+            out += linesize;
+            for (i = 1; i < repeat; i++) {
+                memcpy(out, line, linesize);
+                out += linesize;
+            }
+        }
+        if (reply->memfd >= 0) {
+            if (!server_memfd_seal(buf, reply->size, reply->memfd)) {
+                buf = NULL;
+            }
+        } else {
+            reply->data = buf;
+        }
+    }
+    aztec_row_reader_free(reader);
+    return buf != NULL;
+}
+
+static
+SERVER_STATUS
+server_encode(
+    const ServerJob* job,
+    ServerReply* reply,
+    gpointer* data)
+{
+    AztecSymbol* symbol;
+    AztecEncodeOptions options;
+    guint64 side, image;
+
+    if (job->format >= SERVER_FORMAT_COUNT || !job->len) {
+        return SERVER_STATUS_BAD_REQUEST;
+    }
+
+    memset(&options, 0, sizeof(options));
+    options.correction = job->correction ? job->correction :
+        AZTEC_CORRECTION_DEFAULT;
+    options.flags = AZTEC_ENCODE_INV;
+    symbol = aztec_encode_with_options(job->payload, job->len, &options);
+    if (!symbol) {
+        return SERVER_STATUS_ENCODE_FAILED;
+    }
+
+    /* Don't let a single request eat all the memory */
+    side = (guint64)(symbol->size + 2 * job->border) * job->scale;
+    image = side * ((job->format == SERVER_FORMAT_PGM) ? side :
+        ((side + 7) / 8));
+    reply->width = reply->height = (guint)side;
+    if (image > SERVER_MAX_IMAGE) {
+        aztec_symbol_free(symbol);
+        return SERVER_STATUS_BAD_REQUEST;
+    }
+
+    switch ((SERVER_FORMAT)job->format) {
+    case SERVER_FORMAT_PBM:
+    case SERVER_FORMAT_PGM:
+    case SERVER_FORMAT_RAW:
+        if (!server_render(job, reply, symbol)) {
+            reply->status = SERVER_STATUS_ERROR;
+        }
+        break;
+    case SERVER_FORMAT_TIFF:
+    case SERVER_FORMAT_ESCPOS:
+        {
+            GBytes* bytes = (job->format == SERVER_FORMAT_TIFF) ?
+                aztec_symbol_tiff(symbol, job->scale, job->border, 0) :
+                aztec_symbol_escpos(symbol, job->scale, job->border, 0);
+            gsize size;
+            const void* ptr = g_bytes_get_data(bytes, &size);
+
+            /* The bytes stay alive until the reply is sent */
+            *data = bytes;
+            if (!server_reply_copy(job, reply, ptr, size)) {
+                reply->status = SERVER_STATUS_ERROR;
+            }
+        }
+        break;
+    case SERVER_FORMAT_ZPL:
+        {
+            char* zpl = aztec_symbol_zpl(symbol, AZTEC_ZPL_ACS, job->scale,
+                job->border);
+            const gsize size = strlen(zpl);
+
+            *data = g_bytes_new_take(zpl, size);
+            if (!server_reply_copy(job, reply, zpl, size)) {
+                reply->status = SERVER_STATUS_ERROR;
+            }
+        }
+        break;
+    case SERVER_FORMAT_COUNT:
+        break;
+    }
+    aztec_symbol_free(symbol);
+    return reply->status;
+}
+
+static
+void
+server_job_run(
+    gpointer data,
+    gpointer user_data)
+{
+    ServerJob* job = data;
+    ServerConn* conn = job->conn;
+    Server* server = user_data;
+    const gint64 start = g_get_monotonic_time();
+    gpointer bytes = NULL;
+    GString* text = NULL;
+    ServerReply reply;
+    struct iovec iov[2];
+    gint64 end;
+    gboolean sent;
+
+    memset(&reply, 0, sizeof(reply));
+    reply.memfd = -1;
+    if (job->op == SERVER_OP_ENCODE) {
+        reply.status = server_encode(job, &reply, &bytes);
+    } else if (job->op == SERVER_OP_STATS) {
+        text = server_stats(server);
+        reply.data = text->str;
+        reply.size = text->len;
+    } else {
+        reply.status = SERVER_STATUS_BAD_REQUEST;
+    }
+
+    if (reply.status != SERVER_STATUS_OK) {
+        if (reply.memfd >= 0) {
+            close(reply.memfd);
+            reply.memfd = -1;
+        }
+        reply.data = NULL;
+        reply.size = 0;
+    }
+
+    server_put32(reply.header, SERVER_REPLY_HEADER - 4 +
+        ((reply.memfd >= 0) ? 0 : reply.size));
+    server_put32(reply.header + 4, job->id);
+    reply.header[8] = (guint8)reply.status;
+    reply.header[9] = (reply.memfd >= 0) ? SERVER_FLAG_MEMFD : 0;
+    server_put32(reply.header + 12, reply.width);
+    server_put32(reply.header + 16, reply.height);
+    server_put32(reply.header + 20, reply.size);
+    iov[0].iov_base = reply.header;
+    iov[0].iov_len = SERVER_REPLY_HEADER;
+    iov[1].iov_base = (void*)reply.data;
+    iov[1].iov_len = (reply.memfd >= 0) ? 0 : reply.size;
+
+    g_mutex_lock(&conn->write_mutex);
+    sent = server_conn_send(conn, iov, iov[1].iov_len ? 2 : 1, reply.memfd);
+    g_mutex_unlock(&conn->write_mutex);
+    if (!sent) {
+        /* Wakes up the reader */
+        shutdown(conn->fd, SHUT_RDWR);
+    }
+
+    if (reply.memfd >= 0) {
+        close(reply.memfd);
+    }
+    if (bytes) {
+        g_bytes_unref(bytes);
+    }
+    if (text) {
+        g_string_free(text, TRUE);
+    }
+
+    end = g_get_monotonic_time();
+    server_hist_add(&server->latency, end - job->start);
+    server_hist_add(&server->service, end - start);
+    __atomic_fetch_add(&server->requests, 1, __ATOMIC_RELAXED);
+    if (reply.status != SERVER_STATUS_OK) {
+        __atomic_fetch_add(&server->failed, 1, __ATOMIC_RELAXED);
+    }
+
+    g_mutex_lock(&conn->mutex);
+    conn->inflight--;
+    g_cond_signal(&conn->cond);
+    g_mutex_unlock(&conn->mutex);
+    server_conn_unref(conn);
+    g_free(job);
+}
+
+static
+gboolean
+server_conn_read(
+    ServerConn* conn,
+    guint8* dest,
+    gsize len)
+{
+    /* Pipelined requests are picked up from the buffer */
+    while (len) {
+        gsize n;
+
+        if (conn->rstart == conn->rend) {
+            const ssize_t nread = read(conn->fd, conn->rbuf,
+                sizeof(conn->rbuf));
+
+            if (nread > 0) {
+                conn->rstart = 0;
+                conn->rend = nread;
+            } else if (nread < 0 && errno == EINTR) {
+                continue;
+            } else {
+                return FALSE;
+            }
+        }
+        n = MIN(len, conn->rend - conn->rstart);
+        memcpy(dest, conn->rbuf + conn->rstart, n);
+        conn->rstart += n;
+        dest += n;
+        len -= n;
+    }
+    return TRUE;
+}
+
+static
+gpointer
+server_conn_thread(
+    gpointer data)
+{
+    ServerConn* conn = data;
+    guint8 header[4 + SERVER_REQUEST_HEADER];
+
+    while (server_conn_read(conn, header, 4)) {
+        const guint32 size = server_get32(header);
+        ServerJob* job;
+        gsize len;
+
+        /* A broken frame can't be skipped, drop the connection */
+        if (size < SERVER_REQUEST_HEADER ||
+            size > SERVER_REQUEST_HEADER + SERVER_MAX_PAYLOAD ||
+            !server_conn_read(conn, header + 4, SERVER_REQUEST_HEADER)) {
+            break;
+        }
+
+        len = size - SERVER_REQUEST_HEADER;
+        job = g_malloc(sizeof(ServerJob) + len);
+        job->payload = (guint8*)(job + 1);
+        if (!server_conn_read(conn, (guint8*)job->payload, len)) {
+            g_free(job);
+            break;
+        }
+        job->conn = conn;
+        job->start = g_get_monotonic_time();
+        job->id = server_get32(header + 4);
+        job->op = header[8];
+        job->format = header[9];
+        job->correction = header[10];
+        job->border = header[11];
+        job->scale = ((guint)header[12] << 8) | header[13];
+        job->flags = ((guint)header[14] << 8) | header[15];
+        job->len = len;
+        if (!job->scale) {
+            job->scale = 1;
+        }
+
+        g_mutex_lock(&conn->mutex);
+        while (conn->inflight >= SERVER_MAX_INFLIGHT) {
+            g_cond_wait(&conn->cond, &conn->mutex);
+        }
+        conn->inflight++;
+        g_mutex_unlock(&conn->mutex);
+
+        g_atomic_int_inc(&conn->refcount);
+        g_thread_pool_push(conn->server->pool, job, NULL);
+    }
+    server_conn_unref(conn);
+    return NULL;
+}
+
+static
+void
+server_conn_new(
+    Server* server,
+    int fd)
+{
+    ServerConn* conn = g_new0(ServerConn, 1);
+    struct timeval tv;
+
+    /* A client not reading the replies must not stall the workers */
+    memset(&tv, 0, sizeof(tv));
+    tv.tv_sec = SERVER_SEND_TIMEOUT;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    conn->server = server;
+    conn->fd = fd;
+    conn->refcount = 1;
+    g_mutex_init(&conn->write_mutex);
+    g_mutex_init(&conn->mutex);
+    g_cond_init(&conn->cond);
+    g_mutex_lock(&server->mutex);
+    server->conns = g_slist_prepend(server->conns, conn);
+    server->active++;
+    g_mutex_unlock(&server->mutex);
+    __atomic_fetch_add(&server->connections, 1, __ATOMIC_RELAXED);
+    g_thread_unref(g_thread_new("conn", server_conn_thread, conn));
+}
+
+static
+int
+server_listen(
+    const char* path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errmsg("%s: %s\n", path, strerror(ENAMETOOLONG));
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0) {
+        struct stat st;
+
+        /* Remove the socket left behind by a dead server */
+        if (!stat(path, &st) && S_ISSOCK(st.st_mode) &&
+            connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 &&
+            errno == ECONNREFUSED) {
+            unlink(path);
+        }
+        if (!bind(fd, (struct sockaddr*)&addr, sizeof(addr)) &&
+            !listen(fd, SOMAXCONN)) {
+            return fd;
+        }
+        errmsg("%s: %s\n", path, strerror(errno));
+        close(fd);
+    } else {
+        errmsg("socket: %s\n", strerror(errno));
+    }
+    return -1;
+}
+
+static
+void
+server_signal(
+    int sig)
+{
+    server_quit = 1;
+}
+
+static
+int
+server_run(
+    const char* path,
+    guint jobs)
+{
+    Server server;
+    struct sigaction sa;
+    sigset_t block, wait;
+    struct pollfd pfd;
+    GString* stats;
+    GSList* l;
+    int fd;
+
+    /* Only the accept loop gets SIGINT and SIGTERM, in ppoll() */
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    sigprocmask(SIG_BLOCK, &block, &wait);
+    sigdelset(&wait, SIGINT);
+    sigdelset(&wait, SIGTERM);
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = server_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    fd = server_listen(path);
+    if (fd < 0) {
+        return RET_ERR;
+    }
+
+    /* Fixed set of workers keeps the per-thread symbol pools warm */
+    memset(&server, 0, sizeof(server));
+    g_mutex_init(&server.mutex);
+    g_cond_init(&server.cond);
+    server.pool = g_thread_pool_new(server_job_run, &server, jobs, TRUE,
+        NULL);
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    while (!server_quit) {
+        if (ppoll(&pfd, 1, NULL, &wait) > 0) {
+            const int conn = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
+
+            if (conn >= 0) {
+                server_conn_new(&server, conn);
+            }
+        }
+    }
+
+    close(fd);
+    unlink(path);
+
+    /* Stop reading requests and let the workers finish what's queued */
+    g_mutex_lock(&server.mutex);
+    for (l = server.conns; l; l = l->next) {
+        shutdown(((ServerConn*)l->data)->fd, SHUT_RD);
+    }
+    while (server.active) {
+        g_cond_wait(&server.cond, &server.mutex);
+    }
+    g_mutex_unlock(&server.mutex);
+    g_thread_pool_free(server.pool, FALSE, TRUE);
+    stats = server_stats(&server);
+    errmsg("%s", stats->str);
+    g_string_free(stats, TRUE);
+    g_mutex_clear(&server.mutex);
+    g_cond_clear(&server.cond);
+    return RET_OK;
+}
+
+int
+main(
+    int argc,
+    char* argv[])
+{
+    int ret = RET_ERR;
+    int jobs = 0;
+    int cache = 16;
+    gboolean ok;
+    GError* error = NULL;
+    GOptionContext* options;
+    GOptionEntry entries[] = {
+        { "jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+          "Number of worker threads [all CPUs]", "N" },
+        { "cache", 'C', 0, G_OPTION_ARG_INT, &cache,
+          "Symbol cache size, zero to disable [16]", "MB" },
+        { NULL }
+    };
+
+    options = g_option_context_new("SOCKET");
+    g_option_context_add_main_entries(options, entries, NULL);
+    g_option_context_set_summary(options,
+        "Encodes Aztec symbols for the clients connected to the UNIX\n"
+        "domain socket. Prints the statistics when terminated.");
+    ok = g_option_context_parse(options, &argc, &argv, &error);
+    if (ok && argc == 2 && jobs >= 0 && cache >= 0) {
+        pgm_expand_init();
+        aztec_cache_set_limit((gsize)cache * 1024 * 1024);
+        ret = server_run(argv[1], jobs ? jobs : g_get_num_processors());
+    } else {
+        if (error) {
+            errmsg("%s\n", error->message);
+            g_error_free(error);
+        } else {
+            char* help = g_option_context_get_help(options, TRUE, NULL);
+            errmsg("%s", help);
+            g_free(help);
+        }
+        ret = RET_CMDLINE;
+    }
+    g_option_context_free(options);
+    return ret;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
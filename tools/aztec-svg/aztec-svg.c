@@ -34,7 +34,9 @@
  * any official policies, either expressed or implied.
  */
 
-#include "aztec_encode.h"
+#include "aztec_render.h"
+#include "tool_batch.h"
+#include "tool_stats.h"
 
 #include <errno.h>
 #include <stdio.h>
@@ -71,6 +73,7 @@ typedef struct svg_size {
 typedef struct app_options {
     SvgSize pixel;
     int border;
+    gboolean path;
 } AppOptions;
 
 static
@@ -97,76 +100,249 @@ options_init(
     opts->border = 1;
 }
 
+/*
+ * Output is accumulated in a large buffer and written out in big chunks,
+ * stdio formatting is only used for a handful of distinct numbers.
+ */
+#define SVG_WRITER_BUF_SIZE (64 * 1024)
+
+typedef struct svg_writer {
+    FILE* out;
+    gsize len;
+    char buf[SVG_WRITER_BUF_SIZE];
+} SvgWriter;
+
 static
-int
-save_symbol(
+void
+svg_writer_flush(
+    SvgWriter* w)
+{
+    if (w->len) {
+        fwrite(w->buf, 1, w->len, w->out);
+        w->len = 0;
+    }
+}
+
+static
+void
+svg_writer_write(
+    SvgWriter* w,
+    const char* str,
+    gsize len)
+{
+    if (w->len + len > sizeof(w->buf)) {
+        svg_writer_flush(w);
+        if (len > sizeof(w->buf)) {
+            fwrite(str, 1, len, w->out);
+            return;
+        }
+    }
+    memcpy(w->buf + w->len, str, len);
+    w->len += len;
+}
+
+static
+inline
+void
+svg_writer_puts(
+    SvgWriter* w,
+    const char* str)
+{
+    svg_writer_write(w, str, strlen(str));
+}
+
+static
+G_GNUC_PRINTF(2,3)
+void
+svg_writer_printf(
+    SvgWriter* w,
+    const char* format,
+    ...)
+{
+    va_list va;
+    char* str;
+
+    va_start(va, format);
+    str = g_strdup_vprintf(format, va);
+    va_end(va);
+    svg_writer_puts(w, str);
+    g_free(str);
+}
+
+static
+void
+svg_writer_int(
+    SvgWriter* w,
+    int value)
+{
+    char buf[16];
+    char* ptr = buf + sizeof(buf);
+    guint v = (value < 0) ? -value : value;
+
+    do {
+        *--ptr = '0' + (v % 10);
+        v /= 10;
+    } while (v);
+    if (value < 0) {
+        *--ptr = '-';
+    }
+    svg_writer_write(w, ptr, buf + sizeof(buf) - ptr);
+}
+
+/*
+ * Single <path> element, one subpath per horizontal run of dark modules.
+ * Coordinates are in modules (the viewBox takes care of scaling), each
+ * subpath starts relative to the previous one.
+ */
+static
+void
+save_symbol_path(
     const AztecSymbol* sym,
     const AppOptions* opts,
-    FILE* out)
+    SvgWriter* w)
 {
-    const double size = (sym->size + 2 * opts->border) * opts->pixel.size;
+    const int n = sym->size + 2 * opts->border;
+    const double size = n * opts->pixel.size;
     const char* unit = (opts->pixel.unit == SVG_UNIT_PX) ? "" :
         svg_units[opts->pixel.unit];
     const char* bgcolor = "#ffffff";
     const char* fgcolor = "#000000";
     const char* indent = "  ";
-    gboolean** rows = g_new(gboolean*, sym->size);
-    gboolean* pixels = g_new(gboolean, sym->size * sym->size);
-    guint i, j;
+    guint i, count;
+    AztecRect* runs = aztec_symbol_runs(sym, &count);
+    int x = 0, y = 0;
 
-    /* Unpack the pixels for convenience */
-    for (i = 0; i < sym->size; i++) {
-        const guint8* ptr = sym->rows[i];
-        gboolean* row = pixels + i * sym->size;
-        guint k = 0;
+    svg_writer_puts(w, "<?xml version=\"1.0\" standalone=\"no\"?>\n");
+    svg_writer_printf(w, "<svg version=\"1.1\" "
+        "width=\"%g%s\" height=\"%g%s\" "
+        "viewBox=\"0 0 %d %d\" "
+        "xmlns=\"http://www.w3.org/2000/svg\">\n",
+         size, unit, size, unit, n, n);
+    svg_writer_printf(w, "%s<rect width=\"%d\" height=\"%d\" "
+        "style=\"fill:%s\"/>\n", indent, n, n, bgcolor);
+    svg_writer_printf(w, "%s<path style=\"fill:%s\" d=\"", indent, fgcolor);
+
+    for (i = 0; i < count; i++) {
+        const AztecRect* r = runs + i;
+        const int rx = r->x + opts->border;
+        const int ry = r->y + opts->border;
+
+        svg_writer_write(w, i ? "m" : "M", 1);
+        svg_writer_int(w, rx - x);
+        svg_writer_write(w, " ", 1);
+        svg_writer_int(w, ry - y);
+        svg_writer_write(w, "h", 1);
+        svg_writer_int(w, r->width);
+        svg_writer_write(w, "v1h-", 4);
+        svg_writer_int(w, r->width);
+        svg_writer_write(w, "z", 1);
+        x = rx;
+        y = ry;
+    }
+    g_free(runs);
+    svg_writer_puts(w, "\"/>\n</svg>\n");
+}
 
-        rows[i] = row;
-        while (k < sym->size) {
-            guint byte = *ptr++;
+static
+void
+save_symbol_rects(
+    const AztecSymbol* sym,
+    const AppOptions* opts,
+    SvgWriter* w)
+{
+    const double size = (sym->size + 2 * opts->border) * opts->pixel.size;
+    const char* unit = (opts->pixel.unit == SVG_UNIT_PX) ? "" :
+        svg_units[opts->pixel.unit];
+    const char* bgcolor = "#ffffff";
+    const char* fgcolor = "#000000";
+    const char* indent = "  ";
+    const guint rowsize = (sym->size + 7) / 8;
+    GString* tail = g_string_new(NULL);
+    char** coord = g_new(char*, sym->size + 1);
+    guint i, k;
 
-            for (j = 0; j < 8 && k < sym->size; k++, j++, byte >>= 1) {
-                row[k] = (byte & 1);
-            }
-        }
+    /* Only sym->size distinct coordinates (same for x and y) */
+    for (i = 0; i < sym->size; i++) {
+        coord[i] = g_strdup_printf("%g",
+            opts->pixel.size * (i + opts->border));
     }
+    coord[i] = NULL;
+    g_string_printf(tail, "\" width=\"%g\" height=\"%g\"/>\n",
+        opts->pixel.size, opts->pixel.size);
 
-    fputs("<?xml version=\"1.0\" standalone=\"no\"?>\n", out);
-    fprintf(out, "<svg version=\"1.1\" "
+    svg_writer_puts(w, "<?xml version=\"1.0\" standalone=\"no\"?>\n");
+    svg_writer_printf(w, "<svg version=\"1.1\" "
         "width=\"%g%s\" height=\"%g%s\" "
         "viewBox=\"0 0 %g %g\" "
         "xmlns=\"http://www.w3.org/2000/svg\">\n",
          size, unit, size, unit, size, size);
 
     /* Background */
-    fprintf(out, "%s<rect x=\"0\" y=\"0\" "
+    svg_writer_printf(w, "%s<rect x=\"0\" y=\"0\" "
         "width=\"%g\" height=\"%g\" "
         "style=\"fill:%s;fill-opacity:1\"/>\n",
         indent, size, size, bgcolor);
 
     /* Symbol */
-    fprintf(out, "%s<g style=\"fill:%s;fill-opacity:1\">\n", indent, fgcolor);
+    svg_writer_printf(w, "%s<g style=\"fill:%s;fill-opacity:1\">\n",
+        indent, fgcolor);
     for (i = 0; i < sym->size; i++) {
-        const gboolean* row = rows[i];
-        const double y = opts->pixel.size * (i + opts->border);
-
-        for (j = 0; j < sym->size; j++) {
-            const double x = opts->pixel.size * (j + opts->border);
-
-            if (row[j]) {
-                fprintf(out, "%s%s<rect x=\"%g\" y=\"%g\" "
-                    "width=\"%g\" height=\"%g\"/>\n",
-                    indent, indent, x, y,
-                    opts->pixel.size, opts->pixel.size);
+        const guint8* row = sym->rows[i];
+        const char* y = coord[i];
+
+        for (k = 0; k < rowsize; k++) {
+            guint byte = row[k];
+
+            /* Left-most module is the least significant bit */
+            while (byte) {
+                const int bit = g_bit_nth_lsf(byte, -1);
+
+                svg_writer_puts(w, "    <rect x=\"");
+                svg_writer_puts(w, coord[k * 8 + bit]);
+                svg_writer_puts(w, "\" y=\"");
+                svg_writer_puts(w, y);
+                svg_writer_write(w, tail->str, tail->len);
+                byte &= byte - 1;
             }
         }
     }
+    svg_writer_printf(w, "%s</g>\n</svg>\n", indent);
 
-    g_free(rows);
-    g_free(pixels);
-    fprintf(out, "%s</g>\n</svg>\n", indent);
+    g_strfreev(coord);
+    g_string_free(tail, TRUE);
+}
+
+static
+int
+save_symbol(
+    const AztecSymbol* sym,
+    const AppOptions* opts,
+    FILE* out)
+{
+    SvgWriter* w = g_new(SvgWriter, 1);
+
+    w->out = out;
+    w->len = 0;
+    if (opts->path) {
+        save_symbol_path(sym, opts, w);
+    } else {
+        save_symbol_rects(sym, opts, w);
+    }
+    svg_writer_flush(w);
+    g_free(w);
     return ferror(out) ? RET_ERR : RET_OK;
 }
 
+static
+gboolean
+save_batch_symbol(
+    const AztecSymbol* sym,
+    FILE* out,
+    gpointer opts)
+{
+    return save_symbol(sym, opts, out) == RET_OK;
+}
+
 static
 gboolean
 parse_svg_size(
@@ -233,8 +409,12 @@ main(
 {
     int ret = RET_ERR;
     gboolean ok;
+    gboolean stats = FALSE;
     const char* file = NULL;
+    const char* batch = NULL;
     int errcorr = AZTEC_CORRECTION_DEFAULT;
+    int jobs = 0;
+    TOOL_BATCH_FORMAT format = TOOL_BATCH_NONE;
     GError* error = NULL;
     AppOptions opts;
     GOptionContext* parser;
@@ -248,6 +428,14 @@ main(
           "Border around the symbol [1]", "PIXELS" },
         { "file", 'f', 0, G_OPTION_ARG_FILENAME, &file,
           "Encode data from FILE", "FILE" },
+        { "path", 0, 0, G_OPTION_ARG_NONE, &opts.path,
+          "Write the symbol as a single path", NULL },
+        { "batch", 'B', 0, G_OPTION_ARG_STRING, &batch,
+          "Encode each record (lines, nul or length)", "FORMAT" },
+        { "jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+          "Number of batch threads [all CPUs]", "N" },
+        { "stats", 0, 0, G_OPTION_ARG_NONE, &stats,
+          "Print encoder statistics to stderr", NULL },
         { NULL }
     };
 
@@ -259,39 +447,62 @@ main(
     g_option_context_set_summary(parser,
         "Generates Aztec symbol as an SVG file.\n\n"
         "If no text is provided on the command line, "
-        "reads the standard input.");
+        "reads the standard input.\n\n"
+        "In batch mode each input record is encoded separately, "
+        "SVG is the file\nname template where %d (e.g. %04d) "
+        "is replaced with the record number.");
 
     ok = g_option_context_parse(parser, &argc, &argv, &error);
-    if (ok && opts.border >= 0 && (argc == 2 || (argc == 3 && !file))) {
-        const char* output = argv[argc - 1];
-        const void* data = NULL;
-        gsize size;
-        GBytes* bytes = NULL;
-
-        if (argc == 2 && (!file || !strcmp(file, "-"))) {
-            GByteArray* buf = g_byte_array_new();
-            int c;
+    if (ok && batch && !tool_batch_parse_format(batch, &format)) {
+        error = g_error_new(G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+            "Invalid batch format \'%s\'", batch);
+        ok = FALSE;
+    }
 
-            /* Read stdin until EOF */
-            while ((c = getchar()) != EOF) {
-                const guint8 byte = (guint8)c;
+    if (ok && format && opts.border >= 0 && jobs >= 0 && argc == 2) {
+        const char* templ = argv[1];
+        char* test = tool_batch_filename(templ, 1);
 
-                g_byte_array_append(buf, &byte, 1);
-            }
-            bytes = g_byte_array_free_to_bytes(buf);
-        } else if (file) {
-            GMappedFile* map = g_mapped_file_new(file, FALSE, &error);
+        if (test || !strcmp(templ, "-")) {
+            GBytes* bytes = tool_read_input(file, &error);
 
-            if (map) {
-                const void* contents = g_mapped_file_get_contents(map);
-                const gsize length = g_mapped_file_get_length(map);
+            if (bytes) {
+                GArray* items = tool_batch_split(bytes, format, errcorr,
+                    &error);
 
-                bytes = g_bytes_new_with_free_func(contents, length,
-                    (GDestroyNotify)g_mapped_file_unref, map);
+                if (items) {
+                    if (tool_batch_run(items, 0, templ, jobs,
+                        save_batch_symbol, &opts)) {
+                        ret = RET_OK;
+                    }
+                    g_array_free(items, TRUE);
+                } else {
+                    errmsg("%s\n", error->message);
+                    g_error_free(error);
+                }
+                g_bytes_unref(bytes);
             } else {
                 errmsg("%s\n", error->message);
                 g_error_free(error);
             }
+        } else {
+            errmsg("Invalid file name template \'%s\'\n", templ);
+            ret = RET_CMDLINE;
+        }
+        g_free(test);
+    } else if (ok && !format && opts.border >= 0 &&
+        (argc == 2 || (argc == 3 && !file))) {
+        const char* output = argv[argc - 1];
+        const void* data = NULL;
+        gsize size;
+        GBytes* bytes = NULL;
+
+        if (argc == 2) {
+            bytes = tool_read_input(file, &error);
+            if (!bytes) {
+                errmsg("%s\n", error->message);
+                g_error_free(error);
+            }
         } else {
             data = argv[1];
             size = strlen(data);
@@ -346,6 +557,9 @@ main(
         }
         ret = RET_CMDLINE;
     }
+    if (stats && ret != RET_CMDLINE) {
+        tool_stats_print(stderr);
+    }
     g_option_context_free(parser);
     return ret;
 }
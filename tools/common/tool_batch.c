@@ -0,0 +1,521 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "tool_batch.h"
+#include "tool_output.h"
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define TOOL_READ_CHUNK (64 * 1024)
+
+/*
+ * Records written to stdout are encoded this many per thread at a time,
+ * which limits the number of rendered records waiting for their turn.
+ */
+#define TOOL_BATCH_STDOUT_CHUNK (32)
+
+typedef enum tool_batch_status {
+    TOOL_BATCH_OK,
+    TOOL_BATCH_ENCODE_FAILED,
+    TOOL_BATCH_OPEN_FAILED,
+    TOOL_BATCH_WRITE_FAILED
+} TOOL_BATCH_STATUS;
+
+typedef struct tool_batch_output {
+    char* buf;
+    size_t size;
+    gboolean ready;
+} ToolBatchOutput;
+
+typedef struct tool_batch {
+    const char* templ;
+    ToolBatchSaveFunc save;
+    gpointer user_data;
+    guint count;
+    guint base;           /* Index of the first record being encoded */
+    guint8* status;
+    int* err;
+    ToolBatchOutput* out; /* NULL unless writing to stdout */
+    ToolOutput* files;    /* NULL when writing to stdout */
+    guint next;           /* Next record to be written to stdout */
+    GMutex mutex;
+    GCond cond;
+} ToolBatch;
+
+gboolean
+tool_batch_parse_format(
+    const char* value,
+    TOOL_BATCH_FORMAT* format)
+{
+    if (!g_ascii_strcasecmp(value, "lines")) {
+        *format = TOOL_BATCH_LINES;
+    } else if (!g_ascii_strcasecmp(value, "nul")) {
+        *format = TOOL_BATCH_NUL;
+    } else if (!g_ascii_strcasecmp(value, "length")) {
+        *format = TOOL_BATCH_LENGTH;
+    } else {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+GBytes*
+tool_read_input(
+    const char* file,
+    GError** error)
+{
+    if (file && strcmp(file, "-")) {
+        GMappedFile* map = g_mapped_file_new(file, FALSE, error);
+
+        if (map) {
+            return g_bytes_new_with_free_func(g_mapped_file_get_contents(map),
+                g_mapped_file_get_length(map),
+                (GDestroyNotify)g_mapped_file_unref, map);
+        }
+        return NULL;
+    } else {
+        GByteArray* buf = g_byte_array_new();
+        gsize n;
+
+        /* Read stdin until EOF, in large chunks */
+        do {
+            const guint len = buf->len;
+
+            g_byte_array_set_size(buf, len + TOOL_READ_CHUNK);
+            n = fread(buf->data + len, 1, TOOL_READ_CHUNK, stdin);
+            g_byte_array_set_size(buf, len + n);
+        } while (n == TOOL_READ_CHUNK);
+        return g_byte_array_free_to_bytes(buf);
+    }
+}
+
+static
+void
+tool_batch_add(
+    GArray* items,
+    const guint8* data,
+    gsize len,
+    guint correction)
+{
+    if (len) {
+        AztecBatchItem item;
+
+        item.data = data;
+        item.len = len;
+        item.correction = correction;
+        g_array_append_val(items, item);
+    }
+}
+
+GArray*
+tool_batch_split(
+    GBytes* input,
+    TOOL_BATCH_FORMAT format,
+    guint correction,
+    GError** error)
+{
+    gsize size;
+    const guint8* ptr = g_bytes_get_data(input, &size);
+    const guint8* end = ptr + size;
+    GArray* items = g_array_new(FALSE, FALSE, sizeof(AztecBatchItem));
+
+    if (format == TOOL_BATCH_LENGTH) {
+        while (ptr < end) {
+            gsize len;
+
+            if (end - ptr < 4) {
+                g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                    "Truncated length prefix at offset %lu",
+                    (gulong)(size - (end - ptr)));
+                g_array_free(items, TRUE);
+                return NULL;
+            }
+            len = ((gsize)ptr[0] << 24) | ((gsize)ptr[1] << 16) |
+                ((gsize)ptr[2] << 8) | ptr[3];
+            ptr += 4;
+            if ((gsize)(end - ptr) < len) {
+                g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                    "Truncated record at offset %lu",
+                    (gulong)(size - (end - ptr)));
+                g_array_free(items, TRUE);
+                return NULL;
+            }
+            tool_batch_add(items, ptr, len, correction);
+            ptr += len;
+        }
+    } else {
+        const int sep = (format == TOOL_BATCH_NUL) ? 0 : '\n';
+
+        while (ptr < end) {
+            const guint8* next = memchr(ptr, sep, end - ptr);
+            gsize len = (next ? next : end) - ptr;
+
+            if (sep && len && ptr[len - 1] == '\r') {
+                len--;
+            }
+            tool_batch_add(items, ptr, len, correction);
+            ptr = next ? (next + 1) : end;
+        }
+    }
+    return items;
+}
+
+char*
+tool_batch_filename(
+    const char* templ,
+    guint number)
+{
+    GString* buf = g_string_sized_new(strlen(templ) + 8);
+    const char* ptr = templ;
+    gboolean have_number = FALSE;
+
+    while (*ptr) {
+        if (ptr[0] != '%') {
+            g_string_append_c(buf, *ptr++);
+        } else if (ptr[1] == '%') {
+            g_string_append_c(buf, '%');
+            ptr += 2;
+        } else {
+            gboolean zero = FALSE;
+            guint width = 0;
+
+            ptr++;
+            if (*ptr == '0') {
+                zero = TRUE;
+                ptr++;
+            }
+            while (g_ascii_isdigit(*ptr) && width < 100) {
+                width = width * 10 + (*ptr++ - '0');
+            }
+            if (*ptr != 'd' || have_number) {
+                g_string_free(buf, TRUE);
+                return NULL;
+            }
+            g_string_append_printf(buf, zero ? "%0*u" : "%*u", width, number);
+            have_number = TRUE;
+            ptr++;
+        }
+    }
+
+    if (have_number) {
+        return g_string_free(buf, FALSE);
+    } else {
+        g_string_free(buf, TRUE);
+        return NULL;
+    }
+}
+
+static
+gpointer
+tool_batch_stdout_thread(
+    gpointer data)
+{
+    ToolBatch* batch = data;
+
+    /* Writes the records to stdout in order, as they become ready */
+    g_mutex_lock(&batch->mutex);
+    while (batch->next < batch->count) {
+        const guint index = batch->next;
+        ToolBatchOutput* out = batch->out + index;
+
+        if (out->ready) {
+            g_mutex_unlock(&batch->mutex);
+            if (out->size &&
+                fwrite(out->buf, 1, out->size, stdout) != out->size) {
+                batch->status[index] = TOOL_BATCH_WRITE_FAILED;
+            }
+            free(out->buf);
+            out->buf = NULL;
+            g_mutex_lock(&batch->mutex);
+            batch->next++;
+            g_cond_broadcast(&batch->cond);
+        } else {
+            g_cond_wait(&batch->cond, &batch->mutex);
+        }
+    }
+    g_mutex_unlock(&batch->mutex);
+    return NULL;
+}
+
+static
+gboolean
+tool_batch_write(
+    ToolBatch* batch,
+    const AztecSymbol* symbol,
+    FILE* f)
+{
+    /* Always closes the file */
+    const gboolean ok = batch->save(symbol, f, batch->user_data);
+
+    return !fclose(f) && ok;
+}
+
+static
+void
+tool_batch_save(
+    guint index,
+    AztecSymbol* symbol,
+    gpointer user_data)
+{
+    ToolBatch* batch = user_data;
+
+    index += batch->base;
+    if (batch->out) {
+        ToolBatchOutput* out = batch->out + index;
+
+        if (symbol) {
+            FILE* f = open_memstream(&out->buf, &out->size);
+
+            if (!f) {
+                batch->status[index] = TOOL_BATCH_WRITE_FAILED;
+                batch->err[index] = errno;
+            } else if (!tool_batch_write(batch, symbol, f)) {
+                batch->status[index] = TOOL_BATCH_WRITE_FAILED;
+                out->size = 0;
+            }
+        } else {
+            batch->status[index] = TOOL_BATCH_ENCODE_FAILED;
+        }
+
+        /* Hand it over to the stdout thread */
+        g_mutex_lock(&batch->mutex);
+        out->ready = TRUE;
+        g_cond_broadcast(&batch->cond);
+        g_mutex_unlock(&batch->mutex);
+    } else if (symbol) {
+        char* buf = NULL;
+        size_t size = 0;
+        FILE* f = open_memstream(&buf, &size);
+
+        /* The file itself is created by the writer thread */
+        if (!f) {
+            batch->status[index] = TOOL_BATCH_WRITE_FAILED;
+            batch->err[index] = errno;
+        } else if (!tool_batch_write(batch, symbol, f)) {
+            batch->status[index] = TOOL_BATCH_WRITE_FAILED;
+            free(buf);
+        } else {
+            tool_output_write(batch->files, index,
+                tool_batch_filename(batch->templ, index + 1), buf, size);
+        }
+    } else {
+        batch->status[index] = TOOL_BATCH_ENCODE_FAILED;
+    }
+    aztec_symbol_free(symbol);
+}
+
+static
+void
+tool_batch_written(
+    guint index,
+    TOOL_OUTPUT_RESULT result,
+    int err,
+    gpointer user_data)
+{
+    ToolBatch* batch = user_data;
+
+    switch (result) {
+    case TOOL_OUTPUT_OK:
+        return;
+    case TOOL_OUTPUT_OPEN_FAILED:
+        batch->status[index] = TOOL_BATCH_OPEN_FAILED;
+        break;
+    case TOOL_OUTPUT_WRITE_FAILED:
+        batch->status[index] = TOOL_BATCH_WRITE_FAILED;
+        break;
+    }
+    batch->err[index] = err;
+}
+
+gboolean
+tool_batch_run(
+    const GArray* items,
+    guint flags,
+    const char* templ,
+    guint jobs,
+    ToolBatchSaveFunc save,
+    gpointer user_data)
+{
+    const AztecBatchItem* data = (const AztecBatchItem*)items->data;
+    const guint count = items->len;
+    const gboolean to_stdout = !strcmp(templ, "-");
+    gboolean ok = TRUE;
+    ToolBatch batch;
+    guint i;
+
+    memset(&batch, 0, sizeof(batch));
+    batch.templ = templ;
+    batch.save = save;
+    batch.user_data = user_data;
+    batch.count = count;
+    batch.status = g_new0(guint8, count);
+    batch.err = g_new0(int, count);
+    if (to_stdout) {
+        /* NULL if there are no records, batch.files stays NULL too */
+        batch.out = g_new0(ToolBatchOutput, count);
+    } else {
+        batch.files = tool_output_new(tool_batch_written, &batch);
+    }
+    g_mutex_init(&batch.mutex);
+    g_cond_init(&batch.cond);
+
+    if (to_stdout) {
+        GThread* writer = g_thread_new("stdout", tool_batch_stdout_thread,
+            &batch);
+        const guint chunk = TOOL_BATCH_STDOUT_CHUNK *
+            (jobs ? jobs : g_get_num_processors());
+
+        /*
+         * The records are encoded chunk by chunk, while the previous
+         * chunk is being written out.
+         */
+        for (i = 0; i < count; i += chunk) {
+            g_mutex_lock(&batch.mutex);
+            while (i - batch.next > chunk) {
+                g_cond_wait(&batch.cond, &batch.mutex);
+            }
+            g_mutex_unlock(&batch.mutex);
+            batch.base = i;
+            aztec_encode_batch_foreach(data + i, MIN(chunk, count - i),
+                flags, jobs, tool_batch_save, &batch);
+        }
+        g_thread_join(writer);
+        fflush(stdout);
+    } else {
+        aztec_encode_batch_foreach(data, count, flags, jobs,
+            tool_batch_save, &batch);
+        tool_output_finish(batch.files);
+    }
+
+    /* Report errors in the record order */
+    for (i = 0; i < count; i++) {
+        const guint n = i + 1;
+        char* fname;
+
+        switch ((TOOL_BATCH_STATUS)batch.status[i]) {
+        case TOOL_BATCH_OK:
+            continue;
+        case TOOL_BATCH_ENCODE_FAILED:
+            fprintf(stderr, "Record %u: failed to generate symbol "
+                "(too much data?)\n", n);
+            break;
+        case TOOL_BATCH_OPEN_FAILED:
+            fname = tool_batch_filename(templ, n);
+            fprintf(stderr, "Record %u: %s: %s\n", n, fname,
+                strerror(batch.err[i]));
+            g_free(fname);
+            break;
+        case TOOL_BATCH_WRITE_FAILED:
+            fprintf(stderr, "Record %u: write error\n", n);
+            break;
+        }
+        ok = FALSE;
+    }
+
+    g_mutex_clear(&batch.mutex);
+    g_cond_clear(&batch.cond);
+    g_free(batch.status);
+    g_free(batch.err);
+    g_free(batch.out);
+    return ok;
+}
+
+gboolean
+tool_batch_sheet(
+    const GArray* items,
+    guint flags,
+    const char* output,
+    guint jobs,
+    guint columns,
+    AztecPixelFormat format,
+    guint scale,
+    guint border,
+    ToolSheetSaveFunc save,
+    gpointer user_data)
+{
+    const guint count = items->len;
+    AztecSymbol** symbols = aztec_encode_batch((const AztecBatchItem*)
+        items->data, count, flags, jobs);
+    AztecRowReader* reader = aztec_row_reader_new_sheet((const AztecSymbol**)
+        symbols, count, columns, format, scale, border);
+    gboolean ok = TRUE;
+    guint i;
+
+    for (i = 0; i < count; i++) {
+        if (!symbols[i]) {
+            fprintf(stderr, "Record %u: failed to generate symbol "
+                "(too much data?)\n", i + 1);
+            ok = FALSE;
+        }
+    }
+
+    if (reader) {
+        if (!strcmp(output, "-")) {
+            if (!save(reader, stdout, user_data) || fflush(stdout)) {
+                fprintf(stderr, "Write error\n");
+                ok = FALSE;
+            }
+        } else {
+            FILE* f = fopen(output, "wb");
+
+            if (f) {
+                /* Always close the file */
+                const gboolean saved = save(reader, f, user_data);
+
+                if (fclose(f) || !saved) {
+                    fprintf(stderr, "%s: write error\n", output);
+                    ok = FALSE;
+                }
+            } else {
+                fprintf(stderr, "%s: %s\n", output, strerror(errno));
+                ok = FALSE;
+            }
+        }
+        aztec_row_reader_free(reader);
+    }
+    aztec_symbol_batch_free(symbols, count);
+    return ok;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
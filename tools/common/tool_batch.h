@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef TOOL_BATCH_H
+#define TOOL_BATCH_H
+
+#include "aztec_render.h"
+
+#include <stdio.h>
+
+typedef enum tool_batch_format {
+    TOOL_BATCH_NONE,
+    TOOL_BATCH_LINES,   /* Newline-delimited, empty lines are skipped */
+    TOOL_BATCH_NUL,     /* NUL-delimited, empty records are skipped */
+    TOOL_BATCH_LENGTH   /* 32-bit big-endian length followed by data */
+} TOOL_BATCH_FORMAT;
+
+/* Parses the --batch option value (lines, nul or length) */
+gboolean
+tool_batch_parse_format(
+    const char* value,
+    TOOL_BATCH_FORMAT* format);
+
+/* Reads the whole file (or stdin if file is NULL or "-") */
+GBytes*
+tool_read_input(
+    const char* file,
+    GError** error);
+
+/*
+ * Returns the array of AztecBatchItem pointing into the input, which
+ * therefore has to stay alive while the items are in use. Empty records
+ * are skipped.
+ */
+GArray*
+tool_batch_split(
+    GBytes* input,
+    TOOL_BATCH_FORMAT format,
+    guint correction,
+    GError** error);
+
+/*
+ * Expands %d (optionally with zero padding and width, e.g. %04d) into
+ * the record number, %% into %. Returns NULL if the template is invalid.
+ */
+char*
+tool_batch_filename(
+    const char* templ,
+    guint number);
+
+typedef
+gboolean
+(*ToolBatchSaveFunc)(
+    const AztecSymbol* symbol,
+    FILE* out,
+    gpointer user_data);
+
+/*
+ * Encodes the records with the specified aztec_encode_batch() flags on
+ * the specified number of threads (zero for all cores) and saves each
+ * symbol to the file named after the template. If the template is "-"
+ * the output goes to stdout in the record order.
+ */
+gboolean
+tool_batch_run(
+    const GArray* items,
+    guint flags,
+    const char* templ,
+    guint jobs,
+    ToolBatchSaveFunc save,
+    gpointer user_data);
+
+typedef
+gboolean
+(*ToolSheetSaveFunc)(
+    AztecRowReader* reader,
+    FILE* out,
+    gpointer user_data);
+
+/*
+ * Encodes all the records and saves them as a single image (or "-" for
+ * stdout), laid out on a grid with the specified number of columns, see
+ * aztec_row_reader_new_sheet(). Records which can't be encoded leave
+ * their cells empty and are reported as errors.
+ */
+gboolean
+tool_batch_sheet(
+    const GArray* items,
+    guint flags,
+    const char* output,
+    guint jobs,
+    guint columns,
+    AztecPixelFormat format,
+    guint scale,
+    guint border,
+    ToolSheetSaveFunc save,
+    gpointer user_data);
+
+#endif /* TOOL_BATCH_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,637 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "tool_output.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef TOOL_IO_URING
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#endif
+
+/*
+ * The writer takes up to TOOL_OUTPUT_BATCH files at a time. The encoding
+ * threads are only held back when more than TOOL_OUTPUT_MAX_PENDING bytes
+ * are waiting to be written.
+ */
+#define TOOL_OUTPUT_BATCH (64)
+#define TOOL_OUTPUT_MAX_PENDING (64 * 1024 * 1024)
+#define TOOL_OUTPUT_OPEN_FLAGS (O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC)
+#define TOOL_OUTPUT_OPEN_MODE (0666)
+
+typedef struct tool_output_job {
+    guint index;
+    char* fname;
+    char* data;
+    gsize size;
+    gsize written;
+    int fd;
+    gboolean sync;      /* Has to be finished synchronously */
+    TOOL_OUTPUT_RESULT result;
+    int err;
+} ToolOutputJob;
+
+#ifdef TOOL_IO_URING
+
+typedef struct tool_uring {
+    int fd;
+    guint sq_tail;
+    guint* sq_ktail;
+    guint sq_mask;
+    guint* sq_array;
+    struct io_uring_sqe* sqes;
+    guint* cq_khead;
+    guint* cq_ktail;
+    guint cq_mask;
+    struct io_uring_cqe* cqes;
+    void* sq_ring;
+    gsize sq_ring_size;
+    void* cq_ring;
+    gsize cq_ring_size;
+    gsize sqes_size;
+    guint inflight;     /* Submitted but not completed yet */
+} ToolUring;
+
+/* User data of a completion: job number in the batch and the operation */
+#define TOOL_URING_OP_WRITE (0)
+#define TOOL_URING_OP_CLOSE (1)
+#define TOOL_URING_DATA(i,op) (((__u64)(i) << 1) | (op))
+
+/* Larger files are finished with pwrite */
+#define TOOL_URING_MAX_WRITE (0x40000000)
+
+#endif /* TOOL_IO_URING */
+
+struct tool_output {
+    ToolOutputFunc done;
+    gpointer user_data;
+    GAsyncQueue* queue;
+    GThread* thread;
+    GMutex mutex;
+    GCond cond;
+    gsize pending;
+#ifdef TOOL_IO_URING
+    ToolUring* uring;
+#endif
+};
+
+/* Pushed to the queue by tool_output_finish() */
+static ToolOutputJob tool_output_end;
+
+/* Writes what's left with pwrite */
+static
+void
+tool_output_write_rest(
+    ToolOutputJob* job)
+{
+    while (job->written < job->size) {
+        const ssize_t n = pwrite(job->fd, job->data + job->written,
+            job->size - job->written, job->written);
+
+        if (n > 0) {
+            job->written += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            job->result = TOOL_OUTPUT_WRITE_FAILED;
+            job->err = (n < 0) ? errno : EIO;
+            break;
+        }
+    }
+}
+
+static
+void
+tool_output_close(
+    ToolOutputJob* job)
+{
+    if (close(job->fd) && job->result == TOOL_OUTPUT_OK) {
+        job->result = TOOL_OUTPUT_WRITE_FAILED;
+        job->err = errno;
+    }
+    job->fd = -1;
+}
+
+static
+void
+tool_output_sync(
+    ToolOutputJob* job)
+{
+    job->fd = open(job->fname, TOOL_OUTPUT_OPEN_FLAGS, TOOL_OUTPUT_OPEN_MODE);
+    if (job->fd >= 0) {
+        tool_output_write_rest(job);
+        tool_output_close(job);
+    } else {
+        job->result = TOOL_OUTPUT_OPEN_FAILED;
+        job->err = errno;
+    }
+}
+
+#ifdef TOOL_IO_URING
+
+/*
+ * Minimal io_uring setup with raw system calls, so that no extra library
+ * is needed. The ring is only touched by the writer thread.
+ */
+typedef
+void
+(*ToolUringFunc)(
+    ToolOutputJob** jobs,
+    const struct io_uring_cqe* cqe);
+
+/* Handles the available completions, func may be NULL */
+static
+void
+tool_uring_reap(
+    ToolUring* u,
+    ToolOutputJob** jobs,
+    ToolUringFunc func)
+{
+    guint head = *u->cq_khead;
+    const guint tail = __atomic_load_n(u->cq_ktail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        if (func) {
+            func(jobs, u->cqes + (head & u->cq_mask));
+        }
+        head++;
+        u->inflight--;
+    }
+    __atomic_store_n(u->cq_khead, head, __ATOMIC_RELEASE);
+}
+
+/* Waits for the requests in flight, if the kernel lets us */
+static
+void
+tool_uring_wait(
+    ToolUring* u,
+    ToolOutputJob** jobs,
+    ToolUringFunc func)
+{
+    while (u->inflight) {
+        if (syscall(__NR_io_uring_enter, u->fd, 0, u->inflight,
+            IORING_ENTER_GETEVENTS, NULL, 0) >= 0) {
+            tool_uring_reap(u, jobs, func);
+        } else if (errno != EINTR) {
+            break;
+        }
+    }
+}
+
+/* Closing the ring cancels whatever is still in flight after waiting */
+static
+void
+tool_uring_free(
+    ToolUring* u)
+{
+    if (u->cqes) {
+        tool_uring_wait(u, NULL, NULL);
+    }
+    if (u->sqes) {
+        munmap(u->sqes, u->sqes_size);
+    }
+    if (u->cq_ring && u->cq_ring != u->sq_ring) {
+        munmap(u->cq_ring, u->cq_ring_size);
+    }
+    if (u->sq_ring) {
+        munmap(u->sq_ring, u->sq_ring_size);
+    }
+    close(u->fd);
+    g_free(u);
+}
+
+static
+void*
+tool_uring_map(
+    int fd,
+    gsize size,
+    __u64 offset)
+{
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, fd, offset);
+
+    return (ptr == MAP_FAILED) ? NULL : ptr;
+}
+
+static
+ToolUring*
+tool_uring_new(
+    guint entries)
+{
+    struct io_uring_params p;
+    int fd;
+
+    memset(&p, 0, sizeof(p));
+    fd = syscall(__NR_io_uring_setup, entries, &p);
+    if (fd >= 0) {
+        ToolUring* u = g_new0(ToolUring, 1);
+        guint8* sq;
+        guint8* cq;
+
+        u->fd = fd;
+        u->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(__u32);
+        u->cq_ring_size = p.cq_off.cqes + p.cq_entries *
+            sizeof(struct io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+            u->sq_ring_size = u->cq_ring_size = MAX(u->sq_ring_size,
+                u->cq_ring_size);
+        }
+        u->sq_ring = tool_uring_map(fd, u->sq_ring_size, IORING_OFF_SQ_RING);
+        u->cq_ring = (p.features & IORING_FEAT_SINGLE_MMAP) ? u->sq_ring :
+            tool_uring_map(fd, u->cq_ring_size, IORING_OFF_CQ_RING);
+        u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+        u->sqes = tool_uring_map(fd, u->sqes_size, IORING_OFF_SQES);
+        if (u->sq_ring && u->cq_ring && u->sqes) {
+            sq = u->sq_ring;
+            cq = u->cq_ring;
+            u->sq_ktail = (guint*)(sq + p.sq_off.tail);
+            u->sq_mask = *(guint*)(sq + p.sq_off.ring_mask);
+            u->sq_array = (guint*)(sq + p.sq_off.array);
+            u->sq_tail = *u->sq_ktail;
+            u->cq_khead = (guint*)(cq + p.cq_off.head);
+            u->cq_ktail = (guint*)(cq + p.cq_off.tail);
+            u->cq_mask = *(guint*)(cq + p.cq_off.ring_mask);
+            u->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+            return u;
+        }
+        tool_uring_free(u);
+    }
+    return NULL;
+}
+
+static
+struct io_uring_sqe*
+tool_uring_sqe(
+    ToolUring* u,
+    __u8 opcode,
+    int fd,
+    __u64 user_data)
+{
+    /* The ring is empty at the beginning of each round */
+    const guint i = u->sq_tail++ & u->sq_mask;
+    struct io_uring_sqe* sqe = u->sqes + i;
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->user_data = user_data;
+    u->sq_array[i] = i;
+    return sqe;
+}
+
+/*
+ * Submits everything queued so far and waits for the completions.
+ * Returns zero on success or errno of the failed system call.
+ */
+static
+int
+tool_uring_run(
+    ToolUring* u,
+    guint submit,
+    ToolOutputJob** jobs,
+    ToolUringFunc func)
+{
+    __atomic_store_n(u->sq_ktail, u->sq_tail, __ATOMIC_RELEASE);
+    while (submit || u->inflight) {
+        const int ret = syscall(__NR_io_uring_enter, u->fd, submit,
+            submit + u->inflight, IORING_ENTER_GETEVENTS, NULL, 0);
+
+        if (ret >= 0) {
+            const guint n = MIN((guint)ret, submit);
+
+            submit -= n;
+            u->inflight += n;
+            tool_uring_reap(u, jobs, func);
+        } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            const int err = errno;
+
+            /* Don't leave the submitted requests behind */
+            tool_uring_wait(u, jobs, func);
+            return err;
+        }
+    }
+    return 0;
+}
+
+static
+void
+tool_uring_opened(
+    ToolOutputJob** jobs,
+    const struct io_uring_cqe* cqe)
+{
+    ToolOutputJob* job = jobs[cqe->user_data >> 1];
+
+    if (cqe->res >= 0) {
+        job->fd = cqe->res;
+    } else if (cqe->res == -EINVAL) {
+        /* The kernel is too old for IORING_OP_OPENAT */
+        job->sync = TRUE;
+    } else {
+        job->result = TOOL_OUTPUT_OPEN_FAILED;
+        job->err = -cqe->res;
+    }
+}
+
+static
+void
+tool_uring_written(
+    ToolOutputJob** jobs,
+    const struct io_uring_cqe* cqe)
+{
+    ToolOutputJob* job = jobs[cqe->user_data >> 1];
+
+    if ((cqe->user_data & 1) == TOOL_URING_OP_WRITE) {
+        if (cqe->res >= 0) {
+            job->written = cqe->res;
+        } else {
+            job->result = TOOL_OUTPUT_WRITE_FAILED;
+            job->err = -cqe->res;
+        }
+    } else if (cqe->res == -ECANCELED) {
+        /* Short or failed write breaks the link, finish it by hand */
+        job->sync = TRUE;
+    } else {
+        if (job->result == TOOL_OUTPUT_OK) {
+            if (cqe->res < 0) {
+                job->result = TOOL_OUTPUT_WRITE_FAILED;
+                job->err = -cqe->res;
+            } else if (job->written != job->size) {
+                job->result = TOOL_OUTPUT_WRITE_FAILED;
+                job->err = EIO;
+            }
+        }
+        job->fd = -1;
+    }
+}
+
+/*
+ * Opens the whole batch with one system call, then writes and closes
+ * everything with another one (each write linked with its close).
+ * Returns zero on success or errno.
+ */
+static
+int
+tool_uring_jobs(
+    ToolUring* u,
+    ToolOutputJob** jobs,
+    guint n)
+{
+    guint i, submit = 0;
+    int err;
+
+    for (i = 0; i < n; i++) {
+        struct io_uring_sqe* sqe = tool_uring_sqe(u, IORING_OP_OPENAT,
+            AT_FDCWD, TOOL_URING_DATA(i, TOOL_URING_OP_WRITE));
+
+        sqe->addr = (__u64)(gsize)jobs[i]->fname;
+        sqe->len = TOOL_OUTPUT_OPEN_MODE;
+        sqe->open_flags = TOOL_OUTPUT_OPEN_FLAGS;
+    }
+    err = tool_uring_run(u, n, jobs, tool_uring_opened);
+    if (err) {
+        return err;
+    }
+
+    for (i = 0; i < n; i++) {
+        ToolOutputJob* job = jobs[i];
+
+        if (job->fd >= 0) {
+            if (job->size) {
+                struct io_uring_sqe* sqe = tool_uring_sqe(u, IORING_OP_WRITE,
+                    job->fd, TOOL_URING_DATA(i, TOOL_URING_OP_WRITE));
+
+                sqe->addr = (__u64)(gsize)job->data;
+                sqe->len = (__u32)MIN(job->size, TOOL_URING_MAX_WRITE);
+                submit++;
+                if (job->size > TOOL_URING_MAX_WRITE) {
+                    /* The rest is written (and the file closed) by hand */
+                    job->sync = TRUE;
+                    continue;
+                }
+                sqe->flags = IOSQE_IO_LINK;
+            }
+            tool_uring_sqe(u, IORING_OP_CLOSE, job->fd,
+                TOOL_URING_DATA(i, TOOL_URING_OP_CLOSE));
+            submit++;
+        }
+    }
+    return submit ? tool_uring_run(u, submit, jobs, tool_uring_written) : 0;
+}
+
+#endif /* TOOL_IO_URING */
+
+static
+void
+tool_output_jobs(
+    ToolOutput* out,
+    ToolOutputJob** jobs,
+    guint n)
+{
+    guint i;
+
+#ifdef TOOL_IO_URING
+    ToolUring* u = out->uring;
+
+    if (u) {
+        const int err = tool_uring_jobs(u, jobs, n);
+        gboolean drop = FALSE;
+
+        if (err) {
+            /* Shouldn't happen, don't touch the ring again */
+            tool_uring_free(u);
+            out->uring = NULL;
+            for (i = 0; i < n; i++) {
+                ToolOutputJob* job = jobs[i];
+
+                if (job->result == TOOL_OUTPUT_OK) {
+                    job->result = TOOL_OUTPUT_WRITE_FAILED;
+                    job->err = err;
+                }
+                if (job->fd >= 0) {
+                    tool_output_close(job);
+                }
+            }
+            return;
+        }
+        for (i = 0; i < n; i++) {
+            ToolOutputJob* job = jobs[i];
+
+            if (job->sync) {
+                if (job->fd >= 0) {
+                    if (job->result == TOOL_OUTPUT_OK) {
+                        tool_output_write_rest(job);
+                    }
+                    tool_output_close(job);
+                } else {
+                    /* The kernel can't open files through the ring */
+                    drop = TRUE;
+                    tool_output_sync(job);
+                }
+            }
+        }
+        if (drop) {
+            tool_uring_free(u);
+            out->uring = NULL;
+        }
+        return;
+    }
+#endif
+
+    for (i = 0; i < n; i++) {
+        tool_output_sync(jobs[i]);
+    }
+}
+
+static
+gpointer
+tool_output_thread(
+    gpointer data)
+{
+    ToolOutput* out = data;
+    ToolOutputJob* jobs[TOOL_OUTPUT_BATCH];
+    gboolean done = FALSE;
+
+    while (!done) {
+        ToolOutputJob* job = g_async_queue_pop(out->queue);
+        gsize bytes = 0;
+        guint i, n = 0;
+
+        /* Take whatever else is already there */
+        while (job) {
+            if (job == &tool_output_end) {
+                done = TRUE;
+                break;
+            }
+            jobs[n++] = job;
+            job = (n < TOOL_OUTPUT_BATCH) ?
+                g_async_queue_try_pop(out->queue) : NULL;
+        }
+
+        if (n) {
+            tool_output_jobs(out, jobs, n);
+            for (i = 0; i < n; i++) {
+                job = jobs[i];
+                out->done(job->index, job->result, job->err, out->user_data);
+                bytes += job->size;
+                free(job->data);
+                g_free(job->fname);
+                g_slice_free(ToolOutputJob, job);
+            }
+
+            g_mutex_lock(&out->mutex);
+            out->pending -= bytes;
+            g_cond_broadcast(&out->cond);
+            g_mutex_unlock(&out->mutex);
+        }
+    }
+    return NULL;
+}
+
+ToolOutput*
+tool_output_new(
+    ToolOutputFunc done,
+    gpointer user_data)
+{
+    ToolOutput* out = g_new0(ToolOutput, 1);
+
+    out->done = done;
+    out->user_data = user_data;
+    out->queue = g_async_queue_new();
+    g_mutex_init(&out->mutex);
+    g_cond_init(&out->cond);
+#ifdef TOOL_IO_URING
+    /* A write and a close per file */
+    out->uring = tool_uring_new(2 * TOOL_OUTPUT_BATCH);
+#endif
+    out->thread = g_thread_new("output", tool_output_thread, out);
+    return out;
+}
+
+void
+tool_output_write(
+    ToolOutput* out,
+    guint index,
+    char* fname,
+    char* data,
+    gsize size)
+{
+    ToolOutputJob* job = g_slice_new0(ToolOutputJob);
+
+    job->index = index;
+    job->fname = fname;
+    job->data = data;
+    job->size = size;
+    job->fd = -1;
+
+    g_mutex_lock(&out->mutex);
+    while (out->pending && out->pending + size > TOOL_OUTPUT_MAX_PENDING) {
+        g_cond_wait(&out->cond, &out->mutex);
+    }
+    out->pending += size;
+    g_mutex_unlock(&out->mutex);
+    g_async_queue_push(out->queue, job);
+}
+
+void
+tool_output_finish(
+    ToolOutput* out)
+{
+    g_async_queue_push(out->queue, &tool_output_end);
+    g_thread_join(out->thread);
+#ifdef TOOL_IO_URING
+    if (out->uring) {
+        tool_uring_free(out->uring);
+    }
+#endif
+    g_async_queue_unref(out->queue);
+    g_mutex_clear(&out->mutex);
+    g_cond_clear(&out->cond);
+    g_free(out);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
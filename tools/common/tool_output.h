@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#ifndef TOOL_OUTPUT_H
+#define TOOL_OUTPUT_H
+
+#include <glib.h>
+
+/*
+ * Asynchronous file output for batch mode. The encoding threads hand
+ * over finished files (name and contents) and go on encoding, a single
+ * writer thread creates them. The files are written with open, pwrite
+ * and close or, if the tools are built with IO_URING=1 and the kernel
+ * allows it, through io_uring, many files per system call.
+ *
+ * tool_output_write() takes ownership of the file name (g_free) and
+ * the data (free, as returned by open_memstream). It only blocks if
+ * too much data is waiting to be written. The callback is invoked on
+ * the writer thread when the file is done, err being zero on success.
+ * tool_output_finish() waits for all files to be written and frees
+ * the object.
+ */
+
+typedef enum tool_output_result {
+    TOOL_OUTPUT_OK,
+    TOOL_OUTPUT_OPEN_FAILED,
+    TOOL_OUTPUT_WRITE_FAILED
+} TOOL_OUTPUT_RESULT;
+
+typedef struct tool_output ToolOutput;
+
+typedef
+void
+(*ToolOutputFunc)(
+    guint index,
+    TOOL_OUTPUT_RESULT result,
+    int err,
+    gpointer user_data);
+
+ToolOutput*
+tool_output_new(
+    ToolOutputFunc done,
+    gpointer user_data);
+
+void
+tool_output_write(
+    ToolOutput* out,
+    guint index,
+    char* fname,
+    char* data,
+    gsize size);
+
+void
+tool_output_finish(
+    ToolOutput* out);
+
+#endif /* TOOL_OUTPUT_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "tool_stats.h"
+
+#include "aztec_encode.h"
+
+static const char* const tool_stats_stage_names[] = {
+    "segment", "config", "stuff", "rs", "mode", "place", "export"
+};
+G_STATIC_ASSERT(G_N_ELEMENTS(tool_stats_stage_names) == AZTEC_STAGE_COUNT);
+
+void
+tool_stats_print(
+    FILE* out)
+{
+    AztecStats stats;
+
+    if (aztec_stats_snapshot(&stats)) {
+        guint64 total = 0;
+        guint i;
+
+        fprintf(out, "Symbols encoded:      %" G_GUINT64_FORMAT "\n"
+            "Payload bytes:        %" G_GUINT64_FORMAT "\n"
+            "Segments:             %" G_GUINT64_FORMAT "\n"
+            "Mode latches:         %" G_GUINT64_FORMAT "\n"
+            "Mode shifts:          %" G_GUINT64_FORMAT "\n"
+            "Stuffing rounds:      %" G_GUINT64_FORMAT "\n"
+            "Stuffed bits:         %" G_GUINT64_FORMAT "\n"
+            "Config lookups:       %" G_GUINT64_FORMAT "\n"
+            "Config iterations:    %" G_GUINT64_FORMAT "\n"
+            "Codewords:            %" G_GUINT64_FORMAT "\n\n",
+            stats.encodes, stats.bytes, stats.blocks, stats.latches,
+            stats.shifts, stats.stuffing_rounds, stats.stuffed_bits,
+            stats.config_picks, stats.config_iterations, stats.codewords);
+
+        for (i = 0; i < AZTEC_STAGE_COUNT; i++) {
+            total += stats.ns[i];
+        }
+        fprintf(out, "%-8s %12s %12s %7s\n", "Stage", "Total ms",
+            "ns/symbol", "Share");
+        for (i = 0; i < AZTEC_STAGE_COUNT; i++) {
+            fprintf(out, "%-8s %12.3f %12.0f %6.1f%%\n",
+                tool_stats_stage_names[i], stats.ns[i] / 1e6,
+                stats.encodes ? (double)stats.ns[i] / stats.encodes : 0.,
+                total ? 100. * stats.ns[i] / total : 0.);
+        }
+        fprintf(out, "%-8s %12.3f %12.0f\n", "total", total / 1e6,
+            stats.encodes ? (double)total / stats.encodes : 0.);
+    } else {
+        fprintf(out, "No statistics, libaztec was built without "
+            "AZTEC_STATS=1\n");
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
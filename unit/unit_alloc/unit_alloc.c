@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_encode.h"
+#include "aztec_rs.h"
+
+#include "test_alloc.h"
+
+#include <string.h>
+
+/* Counts the allocations made between alloc_start() and alloc_stop() */
+static guint64 alloc_base;
+
+static
+void
+alloc_start(
+    void)
+{
+    alloc_base = test_alloc_count();
+}
+
+static
+guint
+alloc_stop(
+    void)
+{
+    return (guint)(test_alloc_count() - alloc_base);
+}
+
+/*
+ * Upper limits for the number of allocations, to be lowered as the
+ * allocations go away:
+ *
+ * segment - aztec_encode_measure(), i.e. AztecBlock slices and AztecBits
+ *           (with reallocs) of the segmented data
+ * rs      - Reed-Solomon encoder, i.e. GF tables and generator polynomial
+ * total   - aztec_encode(), the above plus the codewords, the symbol bits
+ *           and the symbol itself
+ */
+typedef struct test_alloc {
+    const char* name;
+    const char* data;
+    gsize len;
+    guint correction;
+    guint max_segment;
+    guint max_rs;
+    guint max_total;
+} TestAlloc;
+
+static const TestAlloc alloc_tests[] = {
+    { "short", "Code 2D!", 8, AZTEC_CORRECTION_DEFAULT, 8, 5, 25 },
+    { "url", "https://example.com/track?id=0042137&ref=mail&lang=en", 53,
+      AZTEC_CORRECTION_DEFAULT, 31, 5, 48 },
+    { "digits", "0123456789012345678901234567890123456789", 40,
+      AZTEC_CORRECTION_HIGH, 4, 5, 21 },
+    { "alternate", "a1B.\x01\xe9" "A:b2\x7f,\x80z", 14,
+      AZTEC_CORRECTION_DEFAULT, 20, 5, 37 },
+    { "binary", NULL, 100, AZTEC_CORRECTION_DEFAULT, 4, 5, 23 },
+    { "long", NULL, 1000, AZTEC_CORRECTION_LOW, 121, 5, 140 }
+};
+
+static
+guint8*
+test_alloc_data(
+    const TestAlloc* test)
+{
+    guint8* data = g_malloc(test->len);
+
+    if (test->data) {
+        memcpy(data, test->data, test->len);
+    } else if (test->len < 256) {
+        gsize i;
+
+        /* Bytes which don't fit any text mode */
+        for (i = 0; i < test->len; i++) {
+            data[i] = 0x80 + (i % 0x80);
+        }
+    } else {
+        static const char text[] = "The quick brown fox jumps over "
+            "the lazy dog. 0123456789! ";
+        gsize i;
+
+        for (i = 0; i < test->len; i++) {
+            data[i] = text[i % (sizeof(text) - 1)];
+        }
+    }
+    return data;
+}
+
+static
+guint
+test_alloc_gfpoly(
+    guint cwsize)
+{
+    switch (cwsize) {
+    case 6: return 0x43;
+    case 8: return 0x12d;
+    case 10: return 0x409;
+    case 12: return 0x1069;
+    }
+    g_assert_not_reached();
+    return 0;
+}
+
+static
+void
+test_alloc(
+    gconstpointer test_data)
+{
+    const TestAlloc* test = test_data;
+    guint8* data = test_alloc_data(test);
+    AztecEncodeInfo info;
+    AztecSymbol* symbol;
+    guint16* cw;
+    guint segment, rs, total;
+
+    /* Warm up whatever glib initializes on the first use */
+    aztec_symbol_free(aztec_encode(data, test->len, test->correction));
+
+    alloc_start();
+    g_assert(aztec_encode_measure(data, test->len, test->correction,
+        &info));
+    segment = alloc_stop();
+
+    cw = g_new0(guint16, info.cwcount);
+    alloc_start();
+    aztec_rs_encode16_full(test_alloc_gfpoly(info.cwsize), 1, cw,
+        info.data_cwcount, cw + info.data_cwcount,
+        info.cwcount - info.data_cwcount);
+    rs = alloc_stop();
+    g_free(cw);
+
+    alloc_start();
+    symbol = aztec_encode(data, test->len, test->correction);
+    total = alloc_stop();
+    g_assert(symbol);
+    g_assert(symbol->size == info.size);
+    aztec_symbol_free(symbol);
+    g_free(data);
+
+    g_test_message("%s: %u layer(s), segment %u, rs %u, total %u",
+        test->name, info.layers, segment, rs, total);
+    g_assert_cmpuint(segment, <=, test->max_segment);
+    g_assert_cmpuint(rs, <=, test->max_rs);
+    g_assert_cmpuint(total, <=, test->max_total);
+}
+
+/* Common */
+
+#define TEST_(x) "/alloc/" x
+
+int main(int argc, char* argv[])
+{
+    guint i;
+
+    /* Make slices countable */
+    test_alloc_init(argv);
+    g_test_init(&argc, &argv, NULL);
+    for (i = 0; i < G_N_ELEMENTS(alloc_tests); i++) {
+        const TestAlloc* test = alloc_tests + i;
+        char* path = g_strconcat(TEST_(""), test->name, NULL);
+
+        g_test_add_data_func(path, test, test_alloc);
+        g_free(path);
+    }
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
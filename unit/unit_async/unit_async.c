@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_encode_async.h"
+
+#include <string.h>
+
+typedef struct test_async {
+    GMainLoop* loop;
+    AztecSymbol* symbol;
+    GError* error;
+} TestAsync;
+
+static
+void
+test_async_init(
+    TestAsync* test)
+{
+    memset(test, 0, sizeof(*test));
+    test->loop = g_main_loop_new(NULL, FALSE);
+}
+
+static
+void
+test_async_deinit(
+    TestAsync* test)
+{
+    aztec_symbol_free(test->symbol);
+    if (test->error) {
+        g_error_free(test->error);
+    }
+    g_main_loop_unref(test->loop);
+}
+
+static
+void
+test_async_done(
+    GObject* source,
+    GAsyncResult* result,
+    gpointer user_data)
+{
+    TestAsync* test = user_data;
+
+    g_assert(!source);
+    test->symbol = aztec_encode_finish(result, &test->error);
+    g_main_loop_quit(test->loop);
+}
+
+/* Basic */
+
+static
+void
+test_basic(
+    void)
+{
+    static const char msg[] = "Code 2D!";
+    AztecSymbol* symbol = aztec_encode_inv(msg, sizeof(msg) - 1,
+        AZTEC_CORRECTION_DEFAULT);
+    char* data = g_strdup(msg);
+    TestAsync test;
+    guint i;
+
+    test_async_init(&test);
+    aztec_encode_async(data, strlen(data), AZTEC_CORRECTION_DEFAULT,
+        AZTEC_ENCODE_INV, NULL, test_async_done, &test);
+
+    /* The data are copied */
+    memset(data, 0, strlen(data));
+    g_free(data);
+
+    g_main_loop_run(test.loop);
+    g_assert(!test.error);
+    g_assert(test.symbol);
+    g_assert(test.symbol->size == symbol->size);
+    for (i = 0; i < symbol->size; i++) {
+        g_assert(!memcmp(test.symbol->rows[i], symbol->rows[i],
+            (symbol->size + 7) / 8));
+    }
+    aztec_symbol_free(symbol);
+    test_async_deinit(&test);
+}
+
+/* TooMuch */
+
+static
+void
+test_toomuch(
+    void)
+{
+    static const char msg[2000] = { 0 };
+    TestAsync test;
+
+    test_async_init(&test);
+    aztec_encode_async(msg, sizeof(msg), AZTEC_CORRECTION_HIGHEST, 0,
+        NULL, test_async_done, &test);
+    g_main_loop_run(test.loop);
+    g_assert(!test.symbol);
+    g_assert(g_error_matches(test.error, AZTEC_ENCODE_ERROR,
+        AZTEC_ENCODE_ERROR_TOO_MUCH_DATA));
+    test_async_deinit(&test);
+}
+
+/* Cancel */
+
+static
+void
+test_cancel(
+    void)
+{
+    static const char msg[] = "Code 2D!";
+    GCancellable* cancel = g_cancellable_new();
+    TestAsync test;
+
+    test_async_init(&test);
+    g_cancellable_cancel(cancel);
+    aztec_encode_async(msg, sizeof(msg) - 1, AZTEC_CORRECTION_DEFAULT, 0,
+        cancel, test_async_done, &test);
+    g_main_loop_run(test.loop);
+    g_assert(!test.symbol);
+    g_assert(g_error_matches(test.error, G_IO_ERROR, G_IO_ERROR_CANCELLED));
+    test_async_deinit(&test);
+    g_object_unref(cancel);
+}
+
+/* Common */
+
+#define TEST_(x) "/async/" x
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("basic"), test_basic);
+    g_test_add_func(TEST_("toomuch"), test_toomuch);
+    g_test_add_func(TEST_("cancel"), test_cancel);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -834,6 +834,526 @@ test_binary2(
     aztec_symbol_free(symbol);
 }
 
+/* Pool */
+
+static
+void
+test_pool(
+    void)
+{
+    static const char msg[] = "Code 2D!";
+    static const char msg2[] = "slava@monich.com";
+    const gsize limit = aztec_symbol_pool_get_limit();
+    AztecSymbol* symbol = aztec_encode(msg, sizeof(msg) - 1,
+        AZTEC_CORRECTION_DEFAULT);
+    AztecSymbol* symbol2;
+
+    /* Released symbol gets reused */
+    g_assert(symbol);
+    aztec_symbol_free(symbol);
+    symbol2 = aztec_encode(msg, sizeof(msg) - 1, AZTEC_CORRECTION_DEFAULT);
+    g_assert(symbol2 == symbol);
+
+    /* But not for a symbol of a different size */
+    symbol = aztec_encode(msg2, sizeof(msg2) - 1, AZTEC_CORRECTION_HIGHEST);
+    g_assert(symbol);
+    g_assert(symbol != symbol2);
+    g_assert(symbol->size != symbol2->size);
+    aztec_symbol_free(symbol);
+    aztec_symbol_free(symbol2);
+    aztec_symbol_pool_trim();
+
+    /* Zero limit disables the pool */
+    aztec_symbol_pool_set_limit(0);
+    g_assert(!aztec_symbol_pool_get_limit());
+    aztec_symbol_free(aztec_encode(msg, sizeof(msg) - 1,
+        AZTEC_CORRECTION_DEFAULT));
+    aztec_symbol_pool_set_limit(limit);
+    aztec_symbol_free(NULL);
+}
+
+/* Batch */
+
+static
+void
+test_batch_check(
+    const AztecBatchItem* item,
+    const AztecSymbol* symbol,
+    guint flags)
+{
+    AztecSymbol* expected = (flags & AZTEC_ENCODE_INV) ?
+        aztec_encode_inv(item->data, item->len, item->correction) :
+        aztec_encode(item->data, item->len, item->correction);
+
+    if (expected) {
+        const gsize rowsize = (expected->size + 7) / 8;
+        guint i;
+
+        g_assert(symbol);
+        g_assert(symbol->size == expected->size);
+        for (i = 0; i < symbol->size; i++) {
+            g_assert(!memcmp(symbol->rows[i], expected->rows[i], rowsize));
+        }
+        aztec_symbol_free(expected);
+    } else {
+        g_assert(!symbol);
+    }
+}
+
+static
+void
+test_batch_count(
+    guint index,
+    AztecSymbol* symbol,
+    gpointer user_data)
+{
+    g_assert(symbol);
+    g_atomic_int_inc((gint*)user_data);
+    aztec_symbol_free(symbol);
+}
+
+static
+void
+test_batch(
+    void)
+{
+    static const char big[1500] = { 0 };
+    static const guint threads[] = { 1, 2, 5, 0 };
+    AztecBatchItem items[37];
+    guint i, k;
+
+    for (i = 0; i < G_N_ELEMENTS(items); i++) {
+        static const char text[] = "Code 2D! slava@monich.com 0123456789";
+        AztecBatchItem* item = items + i;
+
+        /* Mix of small and large payloads */
+        if (i % 7) {
+            item->data = text;
+            item->len = i;
+            item->correction = AZTEC_CORRECTION_LOW + i;
+        } else {
+            item->data = big;
+            item->len = sizeof(big);
+            item->correction = AZTEC_CORRECTION_LOW;
+        }
+    }
+
+    /* Last one is too big */
+    items[G_N_ELEMENTS(items) - 1].correction = AZTEC_CORRECTION_HIGHEST;
+    items[G_N_ELEMENTS(items) - 1].len = sizeof(big);
+
+    for (k = 0; k < G_N_ELEMENTS(threads); k++) {
+        const guint flags = (k & 1) ? AZTEC_ENCODE_INV : 0;
+        AztecSymbol** symbols = aztec_encode_batch(items,
+            G_N_ELEMENTS(items), flags, threads[k]);
+
+        for (i = 0; i < G_N_ELEMENTS(items); i++) {
+            test_batch_check(items + i, symbols[i], flags);
+        }
+        aztec_symbol_batch_free(symbols, G_N_ELEMENTS(items));
+    }
+
+    /* Callback version */
+    k = 0;
+    aztec_encode_batch_foreach(items, G_N_ELEMENTS(items) - 1, 0, 4,
+        test_batch_count, &k);
+    g_assert(k == G_N_ELEMENTS(items) - 1);
+
+    /* Nothing to do */
+    aztec_encode_batch_foreach(items, 0, 0, 0, test_batch_count, NULL);
+    aztec_encode_batch_foreach(items, 1, 0, 0, NULL, NULL);
+    aztec_symbol_batch_free(aztec_encode_batch(NULL, 0, 0, 0), 0);
+    aztec_symbol_batch_free(NULL, 0);
+}
+
+/* measure */
+
+static
+void
+test_measure(
+    void)
+{
+    static const guint correction[] = {
+        AZTEC_CORRECTION_LOW, AZTEC_CORRECTION_MEDIUM,
+        AZTEC_CORRECTION_HIGH, AZTEC_CORRECTION_HIGHEST
+    };
+    static const char text[] = "Code 2D! slava@monich.com 0123456789";
+    guint8 data[2000];
+    AztecEncodeInfo info;
+    guint i, k, len;
+
+    /* Mix of text and binary data */
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (i % 5) ? text[i % (sizeof(text) - 1)] : (guint8)(i * 7);
+    }
+
+    for (k = 0; k < G_N_ELEMENTS(correction); k++) {
+        for (len = 0; len < sizeof(data); len += (len < 64) ? 1 : 97) {
+            AztecSymbol* symbol = aztec_encode(data, len, correction[k]);
+
+            if (symbol) {
+                g_assert(aztec_encode_measure(data, len, correction[k],
+                    &info));
+                g_assert(info.size == symbol->size);
+                g_assert(info.layers);
+                g_assert(info.data_cwcount <= info.cwcount);
+                g_assert(info.data_cwcount * info.cwsize >= info.bits);
+                aztec_symbol_free(symbol);
+            } else {
+                g_assert(!aztec_encode_measure(data, len, correction[k],
+                    &info));
+                g_assert(info.bits);
+                g_assert(!info.size);
+                g_assert(!info.layers);
+            }
+        }
+    }
+
+    /* Empty input fits into the smallest symbol */
+    g_assert(aztec_encode_measure(NULL, 0, AZTEC_CORRECTION_DEFAULT, &info));
+    g_assert(info.compact);
+    g_assert(info.layers == 1);
+    g_assert(info.size == 15);
+    g_assert(aztec_encode_measure(text, 4, AZTEC_CORRECTION_DEFAULT, NULL));
+}
+
+/* correction */
+
+static
+void
+test_correction(
+    void)
+{
+    static const char text[] = "Code 2D! slava@monich.com 0123456789";
+    guint8 data[1000];
+    guint i, len;
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (i % 3) ? text[i % (sizeof(text) - 1)] : (guint8)i;
+    }
+
+    for (len = 1; len < sizeof(data); len += (len < 100) ? 3 : 101) {
+        AztecEncodeInfo prev;
+        guint p;
+
+        memset(&prev, 0, sizeof(prev));
+        for (p = AZTEC_CORRECTION_LOW; p <= AZTEC_CORRECTION_HIGHEST; p++) {
+            AztecEncodeInfo info;
+
+            if (aztec_encode_measure(data, len, p, &info)) {
+                /* Requested percentage of codewords plus 3 */
+                g_assert(info.cwcount - info.data_cwcount >=
+                    info.cwcount * p / 100 + 3);
+                /* More correction never makes the symbol smaller */
+                g_assert(info.size >= prev.size);
+                prev = info;
+            } else {
+                /* And once it doesn't fit, it never fits again */
+                prev.size = G_MAXUINT;
+            }
+        }
+    }
+
+    /* Out of range values are clamped */
+    for (len = 1; len < 100; len += 7) {
+        AztecEncodeInfo i1, i2;
+
+        g_assert(aztec_encode_measure(data, len, 0, &i1));
+        g_assert(aztec_encode_measure(data, len, AZTEC_CORRECTION_LOW, &i2));
+        g_assert(!memcmp(&i1, &i2, sizeof(i1)));
+        g_assert(aztec_encode_measure(data, len, 100, &i1));
+        g_assert(aztec_encode_measure(data, len, AZTEC_CORRECTION_HIGHEST,
+            &i2));
+        g_assert(!memcmp(&i1, &i2, sizeof(i1)));
+    }
+
+    /* Compact symbols are limited to 64 data codewords */
+    memset(data, 0, sizeof(data));
+    for (len = 1; len < 100; len++) {
+        AztecEncodeInfo info;
+
+        g_assert(aztec_encode_measure(data, len, AZTEC_CORRECTION_LOW,
+            &info));
+        if (info.compact) {
+            g_assert(info.data_cwcount <= 64);
+        }
+    }
+}
+
+/* options */
+
+static
+void
+test_options_same(
+    const AztecSymbol* s1,
+    const AztecSymbol* s2)
+{
+    const gsize rowsize = (s1->size + 7) / 8;
+    guint i;
+
+    g_assert(s1->size == s2->size);
+    for (i = 0; i < s1->size; i++) {
+        g_assert(!memcmp(s1->rows[i], s2->rows[i], rowsize));
+    }
+}
+
+static
+void
+test_options(
+    void)
+{
+    static const char text[] = "Code 2D!";
+    static const char big[400] = { 0 };
+    AztecEncodeOptions opts;
+    AztecEncodeInfo info;
+    AztecSymbol* s1;
+    AztecSymbol* s2;
+    guint i;
+
+    /* NULL options */
+    s1 = aztec_encode_with_options(text, 8, NULL);
+    s2 = aztec_encode(text, 8, AZTEC_CORRECTION_DEFAULT);
+    test_options_same(s1, s2);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+    g_assert(aztec_encode_measure_with_options(text, 8, NULL, &info));
+    g_assert(info.size == 15);
+
+    /* Bit order */
+    memset(&opts, 0, sizeof(opts));
+    opts.correction = AZTEC_CORRECTION_HIGH;
+    opts.flags = AZTEC_ENCODE_INV;
+    s1 = aztec_encode_with_options(text, 8, &opts);
+    s2 = aztec_encode_inv(text, 8, AZTEC_CORRECTION_HIGH);
+    test_options_same(s1, s2);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+
+    /* Full range only */
+    memset(&opts, 0, sizeof(opts));
+    opts.layout = AZTEC_LAYOUT_FULL;
+    s1 = aztec_encode_with_options(text, 8, &opts);
+    g_assert(s1->size == 19);
+    aztec_symbol_free(s1);
+    g_assert(aztec_encode_measure_with_options(text, 8, &opts, &info));
+    g_assert(!info.compact);
+    g_assert(info.layers == 1);
+
+    /* Compact only */
+    opts.layout = AZTEC_LAYOUT_COMPACT;
+    opts.min_layers = 4;
+    s1 = aztec_encode_with_options(text, 8, &opts);
+    g_assert(s1->size == 27);
+    aztec_symbol_free(s1);
+    g_assert(!aztec_encode_with_options(big, sizeof(big), &opts));
+    g_assert(!aztec_encode_measure_with_options(big, sizeof(big), &opts,
+        &info));
+
+    /* Pinned geometry */
+    memset(&opts, 0, sizeof(opts));
+    opts.layout = AZTEC_LAYOUT_FULL;
+    opts.min_layers = opts.max_layers = 5;
+    for (i = 0; i < 80; i += 9) {
+        s1 = aztec_encode_with_options(big, i, &opts);
+        g_assert(s1->size == 37);
+        g_assert(aztec_encode_measure_with_options(big, i, &opts, &info));
+        g_assert(info.layers == 5);
+        g_assert(info.size == s1->size);
+        aztec_symbol_free(s1);
+    }
+    g_assert(!aztec_encode_with_options(big, sizeof(big), &opts));
+
+    /* Layer limit applies to both compact and full range symbols */
+    memset(&opts, 0, sizeof(opts));
+    opts.max_layers = 2;
+    s1 = aztec_encode_with_options(big, 20, &opts);
+    g_assert(s1);
+    g_assert(s1->size == 23);
+    aztec_symbol_free(s1);
+    g_assert(aztec_encode_measure_with_options(big, 20, &opts, &info));
+    g_assert(!info.compact);
+    g_assert(info.layers == 2);
+    g_assert(!aztec_encode_with_options(big, 100, &opts));
+}
+
+/* cache */
+
+static
+void
+test_cache(
+    void)
+{
+    static const char text[] = "Code 2D!";
+    AztecCacheStats stats;
+    AztecSymbol* s1;
+    AztecSymbol* s2;
+    AztecSymbol* s3;
+    guint i;
+
+    /* Disabled by default */
+    g_assert(!aztec_cache_get_limit());
+    s1 = aztec_encode(text, 8, AZTEC_CORRECTION_DEFAULT);
+    s2 = aztec_encode(text, 8, AZTEC_CORRECTION_DEFAULT);
+    g_assert(s1 != s2);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+    aztec_cache_get_stats(&stats);
+    g_assert(!stats.hits);
+    g_assert(!stats.misses);
+    g_assert(!stats.count);
+
+    aztec_cache_set_limit(1024*1024);
+    g_assert(aztec_cache_get_limit() == 1024*1024);
+    s1 = aztec_encode(text, 8, AZTEC_CORRECTION_DEFAULT);
+    s2 = aztec_encode(text, 8, AZTEC_CORRECTION_DEFAULT);
+    g_assert(s1 == s2);
+    aztec_symbol_free(s2);
+
+    /* Different correction level and bit order are different keys */
+    s2 = aztec_encode(text, 8, AZTEC_CORRECTION_HIGH);
+    s3 = aztec_encode_inv(text, 8, AZTEC_CORRECTION_DEFAULT);
+    g_assert(s2 != s1);
+    g_assert(s3 != s1);
+    g_assert(s3 != s2);
+    aztec_cache_get_stats(&stats);
+    g_assert(stats.hits == 1);
+    g_assert(stats.misses == 3);
+    g_assert(stats.count == 3);
+    g_assert(stats.bytes > 0);
+
+    /* Cached symbols survive the cache being cleared */
+    aztec_cache_clear();
+    aztec_cache_get_stats(&stats);
+    g_assert(!stats.count);
+    g_assert(!stats.bytes);
+    g_assert(s1->size <= s2->size);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+    aztec_symbol_free(s3);
+
+    /* Too big to be cached at all */
+    aztec_cache_set_limit(16);
+    s1 = aztec_encode(text, 8, AZTEC_CORRECTION_DEFAULT);
+    s2 = aztec_encode(text, 8, AZTEC_CORRECTION_DEFAULT);
+    g_assert(s1 != s2);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+
+    /* Small limit causes eviction */
+    aztec_cache_set_limit(64*1024);
+    for (i = 0; i < 1000; i++) {
+        aztec_symbol_free(aztec_encode(&i, sizeof(i), i % 50));
+    }
+    aztec_cache_get_stats(&stats);
+    g_assert(stats.evictions > 0);
+    g_assert(stats.bytes <= 64*1024);
+    g_assert(stats.count > 0);
+
+    /* Shrinking the limit evicts the entries */
+    aztec_cache_set_limit(0);
+    aztec_cache_get_stats(&stats);
+    g_assert(!stats.count);
+    g_assert(!stats.bytes);
+    g_assert(!aztec_cache_get_limit());
+    g_assert(aztec_symbol_ref(NULL) == NULL);
+}
+
+/* cache_options */
+
+static
+void
+test_cache_options(
+    void)
+{
+    static const char text[] = "Aztec Code is a two-dimensional matrix "
+        "symbology, ISO/IEC 24778.";
+    const gsize len = sizeof(text) - 1;
+    AztecEncodeOptions opts;
+    AztecSymbol* s1;
+    AztecSymbol* s2;
+
+    aztec_cache_set_limit(1024*1024);
+
+    /* Layer counts which don't fit into a byte don't alias small ones */
+    memset(&opts, 0, sizeof(opts));
+    opts.correction = AZTEC_CORRECTION_DEFAULT;
+    opts.max_layers = 257;
+    s1 = aztec_encode_with_options(text, len, &opts);
+    g_assert(s1);
+    g_assert(s1->size == 27);
+    opts.max_layers = 1;
+    g_assert(!aztec_encode_with_options(text, len, &opts));
+
+    /* Large max_layers is the same as no limit */
+    opts.max_layers = 0;
+    s2 = aztec_encode_with_options(text, len, &opts);
+    g_assert(s2 == s1);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+
+    /* Constraints which can't be satisfied */
+    opts.min_layers = 33;
+    g_assert(!aztec_encode_with_options(text, len, &opts));
+    g_assert(!aztec_encode_measure_with_options(text, len, &opts, NULL));
+    opts.min_layers = 3;
+    opts.max_layers = 2;
+    g_assert(!aztec_encode_with_options(text, len, &opts));
+    opts.min_layers = 0;
+    opts.max_layers = 0;
+    opts.layout = 0x101;
+    g_assert(!aztec_encode_with_options(text, len, &opts));
+
+    aztec_cache_set_limit(0);
+}
+
+/* stats */
+
+static
+void
+test_stats(
+    void)
+{
+    static const char text[] = "Hello, World! 0123\x01";
+    AztecStats before, after;
+    AztecSymbol* symbol;
+    guint i;
+
+    if (!aztec_stats_snapshot(&before)) {
+        /* Built without instrumentation */
+        const guint8* ptr = (const guint8*)&before;
+
+        for (i = 0; i < sizeof(before); i++) {
+            g_assert(!ptr[i]);
+        }
+        return;
+    }
+
+    /* Measuring doesn't encode anything */
+    g_assert(aztec_encode_measure(text, sizeof(text) - 1,
+        AZTEC_CORRECTION_DEFAULT, NULL));
+    g_assert(aztec_stats_snapshot(&after));
+    g_assert(after.encodes == before.encodes);
+    g_assert(after.blocks > before.blocks);
+    g_assert(after.config_picks > before.config_picks);
+
+    symbol = aztec_encode(text, sizeof(text) - 1, AZTEC_CORRECTION_DEFAULT);
+    g_assert(symbol);
+    aztec_symbol_free(symbol);
+    before = after;
+    g_assert(aztec_stats_snapshot(&after));
+    g_assert(after.encodes == before.encodes + 1);
+    g_assert(after.bytes == before.bytes + sizeof(text) - 1);
+    g_assert(after.blocks > before.blocks);
+    g_assert(after.latches > before.latches);
+    g_assert(after.shifts > before.shifts);
+    g_assert(after.stuffing_rounds > before.stuffing_rounds);
+    g_assert(after.config_iterations >= after.config_picks);
+    g_assert(after.codewords > before.codewords);
+    for (i = 0; i < AZTEC_STAGE_COUNT; i++) {
+        g_assert(after.ns[i] >= before.ns[i]);
+    }
+}
+
 /* Common */
 
 #define TEST_(x) "/encode/" x
@@ -863,6 +1383,14 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("toomuch"), test_toomuch);
     g_test_add_func(TEST_("binary1"), test_binary1);
     g_test_add_func(TEST_("binary2"), test_binary2);
+    g_test_add_func(TEST_("pool"), test_pool);
+    g_test_add_func(TEST_("batch"), test_batch);
+    g_test_add_func(TEST_("measure"), test_measure);
+    g_test_add_func(TEST_("correction"), test_correction);
+    g_test_add_func(TEST_("options"), test_options);
+    g_test_add_func(TEST_("cache"), test_cache);
+    g_test_add_func(TEST_("cache_options"), test_cache_options);
+    g_test_add_func(TEST_("stats"), test_stats);
     return g_test_run();
 }
 
@@ -0,0 +1,471 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_print.h"
+#include "aztec_render.h"
+
+#include <gio/gio.h>
+
+#include <string.h>
+#include <stdlib.h>
+
+static const char test_msg[] = "Code 2D! slava@monich.com 0123456789";
+
+#define DATA_DIR "data/"
+
+typedef struct test_image {
+    guint width;
+    gsize rowsize;
+    GByteArray* bits;
+} TestImage;
+
+static
+gboolean
+test_image_row(
+    const guint8* row,
+    gsize rowsize,
+    guint repeat,
+    gpointer user_data)
+{
+    TestImage* image = user_data;
+
+    while (repeat--) {
+        g_byte_array_append(image->bits, row, rowsize);
+    }
+    return TRUE;
+}
+
+static
+void
+test_image_init(
+    TestImage* image,
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border)
+{
+    image->width = (symbol->size + 2 * border) * scale;
+    image->rowsize = (image->width + 7) / 8;
+    image->bits = g_byte_array_new();
+    g_assert(aztec_symbol_render(symbol, AZTEC_PIXEL_MONO_MSB, scale, border,
+        test_image_row, image));
+    g_assert_cmpuint(image->bits->len, == ,image->rowsize * image->width);
+}
+
+static
+void
+test_image_deinit(
+    TestImage* image)
+{
+    g_byte_array_unref(image->bits);
+}
+
+/* Returns pointer to the data after "^GFA,total,total,rowsize," */
+static
+const char*
+test_zpl_header(
+    const char* zpl,
+    const TestImage* image)
+{
+    char* end;
+
+    g_assert(g_str_has_prefix(zpl, "^GFA,"));
+    zpl += 5;
+    g_assert_cmpuint(strtoul(zpl, &end, 10), == ,image->bits->len);
+    g_assert(*end == ',');
+    zpl = end + 1;
+    g_assert_cmpuint(strtoul(zpl, &end, 10), == ,image->bits->len);
+    g_assert(*end == ',');
+    zpl = end + 1;
+    g_assert_cmpuint(strtoul(zpl, &end, 10), == ,image->rowsize);
+    g_assert(*end == ',');
+    return end + 1;
+}
+
+static
+int
+test_hex_digit(
+    char c)
+{
+    g_assert(g_ascii_isxdigit(c));
+    return g_ascii_xdigit_value(c);
+}
+
+/* Decodes ZPL compressed ASCII hex */
+static
+GByteArray*
+test_acs_decode(
+    const char* data,
+    gsize rowsize)
+{
+    const gsize n = 2 * rowsize;
+    GByteArray* out = g_byte_array_new();
+    char* row = g_malloc(n);
+    char* prev = g_malloc(n);
+    gsize len = 0;
+    guint count = 0;
+    gsize i;
+
+    for (; *data; data++) {
+        const char c = *data;
+
+        if (c >= 'G' && c <= 'Y') {
+            count += c - 'G' + 1;
+        } else if (c >= 'g' && c <= 'z') {
+            count += (c - 'g' + 1) * 20;
+        } else if (c == ':') {
+            g_assert(!len && !count);
+            g_assert(out->len);
+            memcpy(row, prev, n);
+            len = n;
+        } else if (c == ',' || c == '!') {
+            g_assert(!count);
+            memset(row + len, (c == ',') ? '0' : 'F', n - len);
+            len = n;
+        } else {
+            if (!count) {
+                count = 1;
+            }
+            g_assert_cmpuint(len + count, <= ,n);
+            memset(row + len, c, count);
+            len += count;
+            count = 0;
+        }
+
+        if (len == n) {
+            for (i = 0; i < rowsize; i++) {
+                const guint8 byte = (test_hex_digit(row[2 * i]) << 4) |
+                    test_hex_digit(row[2 * i + 1]);
+
+                g_byte_array_append(out, &byte, 1);
+            }
+            memcpy(prev, row, n);
+            len = 0;
+        }
+    }
+    g_assert(!len && !count);
+    g_free(row);
+    g_free(prev);
+    return out;
+}
+
+static
+guint16
+test_crc16(
+    const char* data,
+    gsize len)
+{
+    guint16 crc = 0;
+    gsize i;
+
+    for (i = 0; i < len; i++) {
+        int k;
+
+        crc ^= ((guint8)data[i]) << 8;
+        for (k = 0; k < 8; k++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static
+GByteArray*
+test_inflate(
+    const guint8* data,
+    gsize len,
+    gsize expected)
+{
+    GConverter* zlib = G_CONVERTER(g_zlib_decompressor_new
+        (G_ZLIB_COMPRESSOR_FORMAT_ZLIB));
+    GByteArray* out = g_byte_array_new();
+    gsize nread = 0, nwritten = 0;
+
+    g_byte_array_set_size(out, expected + 1);
+    g_assert_cmpint(g_converter_convert(zlib, data, len, out->data,
+        out->len, G_CONVERTER_INPUT_AT_END, &nread, &nwritten, NULL), == ,
+        G_CONVERTER_FINISHED);
+    g_assert_cmpuint(nread, == ,len);
+    g_byte_array_set_size(out, nwritten);
+    g_object_unref(zlib);
+    return out;
+}
+
+static
+void
+test_check_zpl(
+    const AztecSymbol* symbol,
+    AztecZplFormat format,
+    guint scale,
+    guint border)
+{
+    char* zpl = aztec_symbol_zpl(symbol, format, scale, border);
+    const char* data;
+    GByteArray* bits = NULL;
+    TestImage image;
+    gsize i;
+
+    test_image_init(&image, symbol, scale, border);
+    g_assert(zpl);
+    data = test_zpl_header(zpl, &image);
+
+    switch (format) {
+    case AZTEC_ZPL_HEX:
+        g_assert_cmpuint(strlen(data), == ,2 * image.bits->len);
+        bits = g_byte_array_new();
+        for (i = 0; data[i]; i += 2) {
+            const guint8 byte = (test_hex_digit(data[i]) << 4) |
+                test_hex_digit(data[i + 1]);
+
+            g_byte_array_append(bits, &byte, 1);
+        }
+        break;
+    case AZTEC_ZPL_ACS:
+        bits = test_acs_decode(data, image.rowsize);
+        break;
+    case AZTEC_ZPL_Z64:
+        {
+            const char* b64 = data + 5;
+            const char* end = strchr(b64, ':');
+            char* str;
+            guchar* zipped;
+            gsize len;
+
+            g_assert(g_str_has_prefix(data, ":Z64:"));
+            g_assert(end);
+            g_assert_cmpuint(strlen(end), == ,5);
+            g_assert_cmpuint(strtoul(end + 1, NULL, 16), == ,
+                test_crc16(b64, end - b64));
+            str = g_strndup(b64, end - b64);
+            zipped = g_base64_decode(str, &len);
+            bits = test_inflate(zipped, len, image.bits->len);
+            g_free(zipped);
+            g_free(str);
+        }
+        break;
+    }
+
+    g_assert(bits);
+    g_assert_cmpuint(bits->len, == ,image.bits->len);
+    g_assert(!memcmp(bits->data, image.bits->data, bits->len));
+    g_byte_array_unref(bits);
+    test_image_deinit(&image);
+    g_free(zpl);
+}
+
+static
+void
+test_check_escpos(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border,
+    guint max_rows)
+{
+    GBytes* escpos = aztec_symbol_escpos(symbol, scale, border, max_rows);
+    GByteArray* bits = g_byte_array_new();
+    const guint8* ptr;
+    const guint8* end;
+    TestImage image;
+    gsize size;
+
+    test_image_init(&image, symbol, scale, border);
+    g_assert(escpos);
+    ptr = g_bytes_get_data(escpos, &size);
+    end = ptr + size;
+    while (ptr < end) {
+        guint x, y;
+
+        g_assert_cmpuint(end - ptr, >= ,8);
+        g_assert_cmpuint(ptr[0], == ,0x1d);
+        g_assert_cmpuint(ptr[1], == ,'v');
+        g_assert_cmpuint(ptr[2], == ,'0');
+        g_assert_cmpuint(ptr[3], == ,0);
+        x = ptr[4] | (ptr[5] << 8);
+        y = ptr[6] | (ptr[7] << 8);
+        g_assert_cmpuint(x, == ,image.rowsize);
+        g_assert_cmpuint(y, > ,0);
+        if (max_rows) {
+            g_assert_cmpuint(y, <= ,max_rows);
+        }
+        ptr += 8;
+        g_assert_cmpuint(end - ptr, >= ,x * y);
+        g_byte_array_append(bits, ptr, x * y);
+        ptr += x * y;
+    }
+
+    g_assert_cmpuint(bits->len, == ,image.bits->len);
+    g_assert(!memcmp(bits->data, image.bits->data, bits->len));
+    g_byte_array_unref(bits);
+    test_image_deinit(&image);
+    g_bytes_unref(escpos);
+}
+
+/* null */
+
+static
+void
+test_null(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+
+    g_assert(!aztec_symbol_zpl(NULL, AZTEC_ZPL_HEX, 1, 0));
+    g_assert(!aztec_symbol_zpl(symbol, AZTEC_ZPL_HEX, 0, 0));
+    g_assert(!aztec_symbol_zpl(symbol, (AztecZplFormat)-1, 1, 0));
+    g_assert(!aztec_symbol_escpos(NULL, 1, 0, 0));
+    g_assert(!aztec_symbol_escpos(symbol, 0, 0, 0));
+    aztec_symbol_free(symbol);
+}
+
+/* zpl */
+
+static
+void
+test_zpl(
+    void)
+{
+    static const guint scale[] = { 1, 2, 3, 8, 11 };
+    static const char* msgs[] = { "A", test_msg, NULL };
+    char* big = g_strnfill(1000, 'z');
+    guint i, k, border;
+
+    msgs[2] = big;
+    for (k = 0; k < G_N_ELEMENTS(msgs); k++) {
+        AztecSymbol* s1 = aztec_encode(msgs[k], strlen(msgs[k]), 0);
+        AztecSymbol* s2 = aztec_encode_inv(msgs[k], strlen(msgs[k]), 0);
+
+        for (i = 0; i < G_N_ELEMENTS(scale); i++) {
+            for (border = 0; border < 3; border++) {
+                test_check_zpl(s1, AZTEC_ZPL_HEX, scale[i], border);
+                test_check_zpl(s1, AZTEC_ZPL_ACS, scale[i], border);
+                test_check_zpl(s1, AZTEC_ZPL_Z64, scale[i], border);
+                test_check_zpl(s2, AZTEC_ZPL_ACS, scale[i], border);
+            }
+        }
+        aztec_symbol_free(s1);
+        aztec_symbol_free(s2);
+    }
+    g_free(big);
+}
+
+/* escpos */
+
+static
+void
+test_escpos(
+    void)
+{
+    static const guint scale[] = { 1, 2, 5, 9 };
+    static const guint rows[] = { 0, 1, 7, 24, 1000 };
+    AztecSymbol* s1 = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    AztecSymbol* s2 = aztec_encode_inv(test_msg, sizeof(test_msg) - 1, 0);
+    guint i, k, border;
+
+    for (i = 0; i < G_N_ELEMENTS(scale); i++) {
+        for (k = 0; k < G_N_ELEMENTS(rows); k++) {
+            for (border = 0; border < 3; border++) {
+                test_check_escpos(s1, scale[i], border, rows[k]);
+                test_check_escpos(s2, scale[i], border, rows[k]);
+            }
+        }
+    }
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+}
+
+/* golden */
+
+static
+void
+test_golden_zpl(
+    const AztecSymbol* symbol,
+    AztecZplFormat format,
+    guint scale,
+    guint border,
+    const char* file)
+{
+    char* zpl = aztec_symbol_zpl(symbol, format, scale, border);
+    char* golden = NULL;
+
+    g_assert(g_file_get_contents(file, &golden, NULL, NULL));
+    g_strchomp(golden);
+    g_assert_cmpstr(zpl, == ,golden);
+    g_free(golden);
+    g_free(zpl);
+}
+
+static
+void
+test_golden(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    GBytes* escpos = aztec_symbol_escpos(symbol, 2, 1, 16);
+    gchar* golden = NULL;
+    gsize len = 0;
+
+    test_golden_zpl(symbol, AZTEC_ZPL_HEX, 1, 1, DATA_DIR "hex_s1_b1.zpl");
+    test_golden_zpl(symbol, AZTEC_ZPL_ACS, 4, 2, DATA_DIR "acs_s4_b2.zpl");
+
+    g_assert(g_file_get_contents(DATA_DIR "escpos_s2_b1_r16.bin", &golden,
+        &len, NULL));
+    g_assert_cmpuint(g_bytes_get_size(escpos), == ,len);
+    g_assert(!memcmp(g_bytes_get_data(escpos, NULL), golden, len));
+    g_bytes_unref(escpos);
+    g_free(golden);
+    aztec_symbol_free(symbol);
+}
+
+/* Common */
+
+#define TEST_(x) "/print/" x
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("zpl"), test_zpl);
+    g_test_add_func(TEST_("escpos"), test_escpos);
+    g_test_add_func(TEST_("golden"), test_golden);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
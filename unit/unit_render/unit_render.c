@@ -0,0 +1,733 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_render.h"
+
+#include <string.h>
+
+static const char test_msg[] = "Code 2D! slava@monich.com 0123456789";
+
+static
+gboolean
+test_module(
+    const AztecSymbol* symbol,
+    guint x,
+    guint y,
+    gboolean inv)
+{
+    const guint8 byte = symbol->rows[y][x / 8];
+
+    return inv ? ((byte >> (7 - x % 8)) & 1) : ((byte >> (x % 8)) & 1);
+}
+
+/* export */
+
+static
+void
+test_export_check(
+    const AztecSymbol* symbol,
+    gboolean inv)
+{
+    static const guint32 dark = 0xff102030;
+    static const guint32 light = 0x80a0b0c0;
+    const guint size = symbol->size;
+    const gsize stride1 = (size + 7) / 8 + 3;
+    const gsize stride8 = size + 5;
+    const gsize stride32 = size * 4 + 8;
+    guint8* lsb = g_malloc0(stride1 * size);
+    guint8* msb = g_malloc0(stride1 * size);
+    guint8* gray = g_malloc0(stride8 * size);
+    guint32* argb = g_malloc0(stride32 * size);
+    guint8* rgba = g_malloc0(stride32 * size);
+    guint x, y;
+
+    g_assert(aztec_symbol_export(symbol, AZTEC_PIXEL_MONO_LSB, 0, 0,
+        lsb, stride1));
+    g_assert(aztec_symbol_export(symbol, AZTEC_PIXEL_MONO_MSB, 0, 0,
+        msb, stride1));
+    g_assert(aztec_symbol_export(symbol, AZTEC_PIXEL_GRAY8, dark, light,
+        gray, stride8));
+    g_assert(aztec_symbol_export(symbol, AZTEC_PIXEL_ARGB32, dark, light,
+        argb, stride32));
+    g_assert(aztec_symbol_export(symbol, AZTEC_PIXEL_RGBA32, dark, light,
+        rgba, stride32));
+
+    for (y = 0; y < size; y++) {
+        const guint8* lsb_row = lsb + y * stride1;
+        const guint8* msb_row = msb + y * stride1;
+        const guint8* gray_row = gray + y * stride8;
+        const guint32* argb_row = (guint32*)((guint8*)argb + y * stride32);
+        const guint8* rgba_row = rgba + y * stride32;
+
+        for (x = 0; x < size; x++) {
+            const gboolean on = test_module(symbol, x, y, inv);
+            const guint32 c = on ? dark : light;
+
+            g_assert(((lsb_row[x / 8] >> (x % 8)) & 1) == on);
+            g_assert(((msb_row[x / 8] >> (7 - x % 8)) & 1) == on);
+            g_assert(gray_row[x] == (guint8)c);
+            g_assert(argb_row[x] == c);
+            g_assert(rgba_row[4 * x] == (guint8)(c >> 16));
+            g_assert(rgba_row[4 * x + 1] == (guint8)(c >> 8));
+            g_assert(rgba_row[4 * x + 2] == (guint8)c);
+            g_assert(rgba_row[4 * x + 3] == (guint8)(c >> 24));
+        }
+
+        /* Padding must remain untouched */
+        g_assert(!lsb_row[stride1 - 1]);
+        g_assert(!msb_row[stride1 - 1]);
+        g_assert(!gray_row[stride8 - 1]);
+        g_assert(!argb_row[stride32 / 4 - 1]);
+    }
+
+    g_free(lsb);
+    g_free(msb);
+    g_free(gray);
+    g_free(argb);
+    g_free(rgba);
+}
+
+static
+void
+test_export(
+    void)
+{
+    guint len;
+
+    /* Different sizes, to exercise both vectorized and scalar paths */
+    for (len = 1; len < sizeof(test_msg); len += 5) {
+        AztecSymbol* s1 = aztec_encode(test_msg, len, len);
+        AztecSymbol* s2 = aztec_encode_inv(test_msg, len, len);
+
+        test_export_check(s1, FALSE);
+        test_export_check(s2, TRUE);
+        aztec_symbol_free(s1);
+        aztec_symbol_free(s2);
+    }
+}
+
+static
+void
+test_export_fail(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode(test_msg, 4, 0);
+    guint8 buf[4 * 15 * 15];
+
+    g_assert(symbol->size == 15);
+    g_assert(!aztec_symbol_export(NULL, AZTEC_PIXEL_GRAY8, 0, 0, buf, 15));
+    g_assert(!aztec_symbol_export(symbol, AZTEC_PIXEL_GRAY8, 0, 0, NULL, 15));
+    g_assert(!aztec_symbol_export(symbol, AZTEC_PIXEL_MONO_LSB, 0, 0, buf, 1));
+    g_assert(!aztec_symbol_export(symbol, AZTEC_PIXEL_GRAY8, 0, 0, buf, 14));
+    g_assert(!aztec_symbol_export(symbol, AZTEC_PIXEL_ARGB32, 0, 0, buf, 59));
+    g_assert(!aztec_symbol_export(symbol, (AztecPixelFormat)-1, 0, 0,
+        buf, 60));
+    aztec_symbol_free(symbol);
+}
+
+/* render */
+
+typedef struct test_render {
+    GByteArray* image;
+    gsize rowsize;
+    guint rows;
+    guint calls;
+    guint stop;
+} TestRender;
+
+static
+gboolean
+test_render_row(
+    const guint8* row,
+    gsize rowsize,
+    guint repeat,
+    gpointer user_data)
+{
+    TestRender* test = user_data;
+    guint i;
+
+    g_assert(repeat);
+    g_assert(rowsize == test->rowsize);
+    for (i = 0; i < repeat; i++) {
+        g_byte_array_append(test->image, row, rowsize);
+    }
+    test->rows += repeat;
+    return (++test->calls != test->stop);
+}
+
+static
+void
+test_render_check(
+    const AztecSymbol* symbol,
+    gboolean inv,
+    AztecPixelFormat format,
+    guint scale,
+    guint border)
+{
+    const gboolean msb = (format == AZTEC_PIXEL_MONO_MSB);
+    const guint n = (symbol->size + 2 * border) * scale;
+    TestRender test;
+    guint x, y;
+
+    memset(&test, 0, sizeof(test));
+    test.image = g_byte_array_new();
+    test.rowsize = (n + 7) / 8;
+    g_assert(aztec_symbol_render(symbol, format, scale, border,
+        test_render_row, &test));
+    g_assert(test.rows == n);
+    g_assert(test.calls < n || scale == 1);
+
+    for (y = 0; y < n; y++) {
+        const guint8* row = test.image->data + y * test.rowsize;
+        const guint my = y / scale;
+
+        for (x = 0; x < test.rowsize * 8; x++) {
+            const guint mx = x / scale;
+            const gboolean bit = msb ?
+                ((row[x / 8] >> (7 - x % 8)) & 1) :
+                ((row[x / 8] >> (x % 8)) & 1);
+
+            if (x >= n || mx < border || my < border ||
+                mx >= border + symbol->size || my >= border + symbol->size) {
+                g_assert(!bit);
+            } else {
+                g_assert(bit == test_module(symbol, mx - border, my - border,
+                    inv));
+            }
+        }
+    }
+    g_byte_array_unref(test.image);
+}
+
+static
+void
+test_render(
+    void)
+{
+    static const guint scale[] = { 1, 2, 3, 5, 7, 8, 9, 12, 20 };
+    AztecSymbol* s1 = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    AztecSymbol* s2 = aztec_encode_inv(test_msg, sizeof(test_msg) - 1, 0);
+    guint i, border;
+
+    for (i = 0; i < G_N_ELEMENTS(scale); i++) {
+        for (border = 0; border < 4; border++) {
+            test_render_check(s1, FALSE, AZTEC_PIXEL_MONO_LSB, scale[i],
+                border);
+            test_render_check(s1, FALSE, AZTEC_PIXEL_MONO_MSB, scale[i],
+                border);
+            test_render_check(s2, TRUE, AZTEC_PIXEL_MONO_LSB, scale[i],
+                border);
+            test_render_check(s2, TRUE, AZTEC_PIXEL_MONO_MSB, scale[i],
+                border);
+        }
+    }
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+}
+
+static
+void
+test_render_stop(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode(test_msg, 4, 0);
+    TestRender test;
+    guint i;
+
+    /* Stop at the top border, in the middle and at the bottom border */
+    for (i = 1; i <= 3; i++) {
+        memset(&test, 0, sizeof(test));
+        test.image = g_byte_array_new();
+        test.rowsize = (symbol->size + 2 + 7) / 8;
+        test.stop = (i == 1) ? 1 : (i == 2) ? 5 : (symbol->size + 2);
+        g_assert(!aztec_symbol_render(symbol, AZTEC_PIXEL_MONO_LSB, 1, 1,
+            test_render_row, &test));
+        g_assert(test.calls == test.stop);
+        g_byte_array_unref(test.image);
+    }
+
+    /* Invalid parameters */
+    g_assert(!aztec_symbol_render(NULL, AZTEC_PIXEL_MONO_LSB, 1, 1,
+        test_render_row, &test));
+    g_assert(!aztec_symbol_render(symbol, AZTEC_PIXEL_MONO_LSB, 1, 1,
+        NULL, NULL));
+    g_assert(!aztec_symbol_render(symbol, AZTEC_PIXEL_MONO_LSB, 0, 1,
+        test_render_row, &test));
+    g_assert(!aztec_symbol_render(symbol, AZTEC_PIXEL_GRAY8, 1, 1,
+        test_render_row, &test));
+    aztec_symbol_free(symbol);
+}
+
+/* reader */
+
+static
+void
+test_reader_check(
+    const AztecSymbol* symbol,
+    AztecPixelFormat format,
+    guint scale,
+    guint border)
+{
+    AztecRowReader* reader = aztec_row_reader_new(symbol, format, scale,
+        border);
+    const gsize rowsize = aztec_row_reader_rowsize(reader);
+    const guint width = aztec_row_reader_width(reader);
+    const guint8* row;
+    TestRender test;
+    guint repeat, i, rows = 0;
+
+    g_assert(width == (symbol->size + 2 * border) * scale);
+    g_assert(rowsize == (width + 7) / 8);
+
+    /* Must match aztec_symbol_render() */
+    memset(&test, 0, sizeof(test));
+    test.image = g_byte_array_new();
+    test.rowsize = rowsize;
+    g_assert(aztec_symbol_render(symbol, format, scale, border,
+        test_render_row, &test));
+
+    while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+        for (i = 0; i < repeat; i++, rows++) {
+            g_assert(!memcmp(row, test.image->data + rows * rowsize,
+                rowsize));
+        }
+    }
+    g_assert(rows == width);
+    g_assert(!aztec_row_reader_next(reader, &repeat));
+    g_assert(!aztec_row_reader_next(reader, NULL));
+    g_byte_array_unref(test.image);
+    aztec_row_reader_free(reader);
+}
+
+static
+void
+test_reader(
+    void)
+{
+    AztecSymbol* s1 = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    AztecSymbol* s2 = aztec_encode_inv(test_msg, 8, 50);
+    guint scale, border;
+
+    for (scale = 1; scale < 12; scale += 2) {
+        for (border = 0; border < 3; border++) {
+            test_reader_check(s1, AZTEC_PIXEL_MONO_LSB, scale, border);
+            test_reader_check(s1, AZTEC_PIXEL_MONO_MSB, scale, border);
+            test_reader_check(s2, AZTEC_PIXEL_MONO_LSB, scale, border);
+            test_reader_check(s2, AZTEC_PIXEL_MONO_MSB, scale, border);
+        }
+    }
+
+    g_assert(!aztec_row_reader_new(NULL, AZTEC_PIXEL_MONO_LSB, 1, 0));
+    g_assert(!aztec_row_reader_new(s1, AZTEC_PIXEL_MONO_LSB, 0, 0));
+    g_assert(!aztec_row_reader_new(s1, AZTEC_PIXEL_ARGB32, 1, 0));
+    g_assert(!aztec_row_reader_next(NULL, NULL));
+    g_assert(!aztec_row_reader_width(NULL));
+    g_assert(!aztec_row_reader_height(NULL));
+    g_assert(!aztec_row_reader_rowsize(NULL));
+    aztec_row_reader_free(NULL);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+}
+
+/* sheet */
+
+static
+gboolean
+test_pixel(
+    const guint8* row,
+    guint x,
+    gboolean msb)
+{
+    return msb ? ((row[x / 8] >> (7 - x % 8)) & 1) :
+        ((row[x / 8] >> (x % 8)) & 1);
+}
+
+static
+void
+test_sheet_check(
+    const AztecSymbol* const* symbols,
+    guint count,
+    guint columns,
+    AztecPixelFormat format,
+    guint scale,
+    guint border)
+{
+    const gboolean msb = (format == AZTEC_PIXEL_MONO_MSB);
+    AztecRowReader* reader = aztec_row_reader_new_sheet(symbols, count,
+        columns, format, scale, border);
+    const guint width = aztec_row_reader_width(reader);
+    const guint height = aztec_row_reader_height(reader);
+    const gsize rowsize = aztec_row_reader_rowsize(reader);
+    TestRender* images = g_new0(TestRender, count);
+    guint8* prev = g_malloc(rowsize);
+    guint i, x, y = 0, size = 0, cell;
+    const guint8* row;
+    guint repeat;
+
+    g_assert(reader);
+    g_assert(aztec_row_reader_format(reader) == format);
+    for (i = 0; i < count; i++) {
+        if (symbols[i]) {
+            /* Each symbol rendered separately without the quiet zone */
+            size = MAX(size, symbols[i]->size);
+            images[i].image = g_byte_array_new();
+            images[i].rowsize = (symbols[i]->size * scale + 7) / 8;
+            g_assert(aztec_symbol_render(symbols[i], format, scale, 0,
+                test_render_row, images + i));
+        }
+    }
+
+    cell = (size + 2 * border) * scale;
+    g_assert_cmpuint(width, == ,columns * cell);
+    g_assert_cmpuint(height, == ,((count + columns - 1) / columns) * cell);
+    g_assert_cmpuint(rowsize, == ,(width + 7) / 8);
+
+    while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+        /* Identical rows come together */
+        g_assert(!y || memcmp(prev, row, rowsize));
+        memcpy(prev, row, rowsize);
+        for (; repeat > 0; repeat--, y++) {
+            for (x = 0; x < rowsize * 8; x++) {
+                const guint k = (y / cell) * columns + x / cell;
+                gboolean bit = FALSE;
+
+                if (x < width && k < count && symbols[k]) {
+                    const guint n = symbols[k]->size * scale;
+                    const guint off = (border + (size - symbols[k]->size) / 2)
+                        * scale;
+                    const guint sx = x % cell, sy = y % cell;
+
+                    if (sx >= off && sx < off + n && sy >= off &&
+                        sy < off + n) {
+                        bit = test_pixel(images[k].image->data +
+                            (sy - off) * images[k].rowsize, sx - off, msb);
+                    }
+                }
+                g_assert(test_pixel(row, x, msb) == bit);
+            }
+        }
+    }
+    g_assert_cmpuint(y, == ,height);
+
+    for (i = 0; i < count; i++) {
+        if (images[i].image) {
+            g_byte_array_unref(images[i].image);
+        }
+    }
+    aztec_row_reader_free(reader);
+    g_free(images);
+    g_free(prev);
+}
+
+static
+void
+test_sheet(
+    void)
+{
+    static const guint scale[] = { 1, 3, 9 };
+    char* big = g_strnfill(300, 'x');
+    const AztecSymbol* symbols[6];
+    AztecSymbol* all[5];
+    guint i, k, border;
+
+    all[0] = aztec_encode("A", 1, 0);
+    all[1] = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    all[2] = aztec_encode_inv(test_msg, sizeof(test_msg) - 1, 0);
+    all[3] = aztec_encode(big, strlen(big), 0);
+    all[4] = aztec_encode_inv("A", 1, 0);
+    for (i = 0; i < G_N_ELEMENTS(all); i++) {
+        symbols[i] = all[i];
+    }
+    symbols[5] = NULL;
+
+    for (i = 0; i < G_N_ELEMENTS(scale); i++) {
+        for (border = 0; border < 3; border += 2) {
+            for (k = 1; k <= 7; k += 2) {
+                test_sheet_check(symbols, G_N_ELEMENTS(symbols), k,
+                    AZTEC_PIXEL_MONO_LSB, scale[i], border);
+                test_sheet_check(symbols, G_N_ELEMENTS(symbols), k,
+                    AZTEC_PIXEL_MONO_MSB, scale[i], border);
+            }
+
+            /* Same symbol in all cells, the rows merge across columns */
+            symbols[1] = symbols[2] = symbols[3] = all[1];
+            test_sheet_check(symbols + 1, 3, 3, AZTEC_PIXEL_MONO_MSB,
+                scale[i], border);
+            test_sheet_check(symbols + 1, 3, 1, AZTEC_PIXEL_MONO_LSB,
+                scale[i], border);
+            symbols[2] = all[2];
+            symbols[3] = all[3];
+        }
+    }
+
+    /* Invalid parameters */
+    symbols[0] = NULL;
+    g_assert(!aztec_row_reader_new_sheet(NULL, 1, 1,
+        AZTEC_PIXEL_MONO_LSB, 1, 0));
+    g_assert(!aztec_row_reader_new_sheet(symbols + 1, 0, 1,
+        AZTEC_PIXEL_MONO_LSB, 1, 0));
+    g_assert(!aztec_row_reader_new_sheet(symbols + 1, 1, 0,
+        AZTEC_PIXEL_MONO_LSB, 1, 0));
+    g_assert(!aztec_row_reader_new_sheet(symbols + 1, 1, 1,
+        AZTEC_PIXEL_MONO_LSB, 0, 0));
+    g_assert(!aztec_row_reader_new_sheet(symbols + 1, 1, 1,
+        AZTEC_PIXEL_GRAY8, 1, 0));
+    g_assert(!aztec_row_reader_new_sheet(symbols, 1, 1,
+        AZTEC_PIXEL_MONO_LSB, 1, 0));
+    symbols[1] = NULL;
+    g_assert(!aztec_row_reader_new_sheet(symbols, 2, 1,
+        AZTEC_PIXEL_MONO_LSB, 1, 2));
+
+    for (i = 0; i < G_N_ELEMENTS(all); i++) {
+        aztec_symbol_free(all[i]);
+    }
+    g_free(big);
+}
+
+/* foreach_row */
+
+typedef struct test_foreach_row {
+    const AztecSymbol* symbol;
+    gboolean inv;
+    gboolean msb;
+    guint count;
+    guint stop;
+} TestForeachRow;
+
+static
+gboolean
+test_foreach_row_cb(
+    guint y,
+    const guint8* row,
+    gsize rowsize,
+    gpointer user_data)
+{
+    TestForeachRow* test = user_data;
+    const AztecSymbol* symbol = test->symbol;
+    guint x;
+
+    g_assert(y == test->count);
+    g_assert(rowsize == (symbol->size + 7) / 8);
+    for (x = 0; x < symbol->size; x++) {
+        const gboolean bit = test->msb ?
+            ((row[x / 8] >> (7 - x % 8)) & 1) :
+            ((row[x / 8] >> (x % 8)) & 1);
+
+        g_assert(bit == test_module(symbol, x, y, test->inv));
+    }
+    return (++test->count != test->stop);
+}
+
+static
+void
+test_foreach_row(
+    void)
+{
+    AztecSymbol* s[2];
+    TestForeachRow test;
+    guint i, k;
+
+    s[0] = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    s[1] = aztec_encode_inv(test_msg, sizeof(test_msg) - 1, 0);
+    for (i = 0; i < G_N_ELEMENTS(s); i++) {
+        for (k = 0; k < 2; k++) {
+            memset(&test, 0, sizeof(test));
+            test.symbol = s[i];
+            test.inv = (i == 1);
+            test.msb = (k == 1);
+            g_assert(aztec_symbol_foreach_row(s[i], test.msb ?
+                AZTEC_PIXEL_MONO_MSB : AZTEC_PIXEL_MONO_LSB,
+                test_foreach_row_cb, &test));
+            g_assert(test.count == s[i]->size);
+
+            /* Stop in the middle */
+            memset(&test, 0, sizeof(test));
+            test.symbol = s[i];
+            test.inv = (i == 1);
+            test.msb = (k == 1);
+            test.stop = 3;
+            g_assert(!aztec_symbol_foreach_row(s[i], test.msb ?
+                AZTEC_PIXEL_MONO_MSB : AZTEC_PIXEL_MONO_LSB,
+                test_foreach_row_cb, &test));
+            g_assert(test.count == 3);
+        }
+    }
+
+    g_assert(!aztec_symbol_foreach_row(NULL, AZTEC_PIXEL_MONO_LSB,
+        test_foreach_row_cb, NULL));
+    g_assert(!aztec_symbol_foreach_row(s[0], AZTEC_PIXEL_MONO_LSB,
+        NULL, NULL));
+    g_assert(!aztec_symbol_foreach_row(s[0], AZTEC_PIXEL_GRAY8,
+        test_foreach_row_cb, NULL));
+    aztec_symbol_free(s[0]);
+    aztec_symbol_free(s[1]);
+}
+
+/* geometry */
+
+static
+void
+test_geometry_check(
+    const AztecSymbol* symbol,
+    gboolean inv)
+{
+    const guint size = symbol->size;
+    guint8* cover1 = g_malloc0(size * size);
+    guint8* cover2 = g_malloc0(size * size);
+    guint nruns, nrects, i, x, y;
+    AztecRect* runs = aztec_symbol_runs(symbol, &nruns);
+    AztecRect* rects = aztec_symbol_rects(symbol, &nrects);
+
+    g_assert(nruns);
+    g_assert(nrects);
+    g_assert(nrects <= nruns);
+
+    for (i = 0; i < nruns; i++) {
+        const AztecRect* r = runs + i;
+
+        g_assert(r->height == 1);
+        g_assert(r->width > 0);
+        g_assert(r->x + r->width <= size);
+        if (i > 0) {
+            const AztecRect* p = r - 1;
+
+            /* Ordered and maximal */
+            g_assert(p->y < r->y || (p->y == r->y &&
+                p->x + p->width < r->x));
+        }
+        if (r->x > 0) {
+            g_assert(!test_module(symbol, r->x - 1, r->y, inv));
+        }
+        if (r->x + r->width < size) {
+            g_assert(!test_module(symbol, r->x + r->width, r->y, inv));
+        }
+        for (x = r->x; x < r->x + r->width; x++) {
+            cover1[r->y * size + x]++;
+        }
+    }
+
+    for (i = 0; i < nrects; i++) {
+        const AztecRect* r = rects + i;
+
+        g_assert(r->width > 0);
+        g_assert(r->height > 0);
+        g_assert(r->x + r->width <= size);
+        g_assert(r->y + r->height <= size);
+        if (i > 0) {
+            g_assert(r[-1].y < r->y || (r[-1].y == r->y && r[-1].x < r->x));
+        }
+        for (y = r->y; y < r->y + r->height; y++) {
+            for (x = r->x; x < r->x + r->width; x++) {
+                cover2[y * size + x]++;
+            }
+        }
+    }
+
+    /* Each dark module is covered exactly once */
+    for (y = 0; y < size; y++) {
+        for (x = 0; x < size; x++) {
+            const guint on = test_module(symbol, x, y, inv);
+
+            g_assert(cover1[y * size + x] == on);
+            g_assert(cover2[y * size + x] == on);
+        }
+    }
+
+    g_free(runs);
+    g_free(rects);
+    g_free(cover1);
+    g_free(cover2);
+}
+
+static
+void
+test_geometry(
+    void)
+{
+    static const guint8 zeros[300] = { 0 };
+    guint len;
+
+    for (len = 1; len < sizeof(test_msg); len += 7) {
+        AztecSymbol* s1 = aztec_encode(test_msg, len, len);
+        AztecSymbol* s2 = aztec_encode_inv(test_msg, len, len);
+
+        test_geometry_check(s1, FALSE);
+        test_geometry_check(s2, TRUE);
+        aztec_symbol_free(s1);
+        aztec_symbol_free(s2);
+    }
+
+    /* Large symbol with long runs */
+    for (len = 100; len <= sizeof(zeros); len += 100) {
+        AztecSymbol* s1 = aztec_encode(zeros, len, 0);
+        AztecSymbol* s2 = aztec_encode_inv(zeros, len, 0);
+
+        test_geometry_check(s1, FALSE);
+        test_geometry_check(s2, TRUE);
+        aztec_symbol_free(s1);
+        aztec_symbol_free(s2);
+    }
+
+    g_assert(!aztec_symbol_runs(NULL, NULL));
+    g_assert(!aztec_symbol_rects(NULL, &len));
+    g_assert(!len);
+}
+
+/* Common */
+
+#define TEST_(x) "/render/" x
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("export"), test_export);
+    g_test_add_func(TEST_("export_fail"), test_export_fail);
+    g_test_add_func(TEST_("render"), test_render);
+    g_test_add_func(TEST_("render_stop"), test_render_stop);
+    g_test_add_func(TEST_("reader"), test_reader);
+    g_test_add_func(TEST_("sheet"), test_sheet);
+    g_test_add_func(TEST_("foreach_row"), test_foreach_row);
+    g_test_add_func(TEST_("geometry"), test_geometry);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "rows_png.h"
+
+#include <zlib.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char test_msg[] = "Code 2D! slava@monich.com 0123456789";
+
+typedef struct test_image {
+    guint width;
+    guint height;
+    gsize rowsize;
+    GByteArray* bits;
+} TestImage;
+
+static
+guint32
+test_get32(
+    const guint8* ptr)
+{
+    return ((guint32)ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3];
+}
+
+static
+void
+test_image_init(
+    TestImage* image,
+    AztecRowReader* reader)
+{
+    const guint8* row;
+    guint repeat;
+
+    image->width = aztec_row_reader_width(reader);
+    image->height = aztec_row_reader_height(reader);
+    image->rowsize = aztec_row_reader_rowsize(reader);
+    image->bits = g_byte_array_new();
+    while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+        while (repeat--) {
+            g_byte_array_append(image->bits, row, image->rowsize);
+        }
+    }
+    g_assert_cmpuint(image->bits->len, == ,image->rowsize * image->height);
+}
+
+static
+void
+test_image_deinit(
+    TestImage* image)
+{
+    g_byte_array_unref(image->bits);
+}
+
+/*
+ * Parses the PNG file, checking the chunk CRCs, inflates the image data
+ * with zlib and compares it with the reference image pixel by pixel.
+ */
+static
+void
+test_check_png(
+    const guint8* png,
+    gsize size,
+    const TestImage* image)
+{
+    static const guint8 signature[8] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'
+    };
+    const gsize n = image->rowsize + 1;
+    GByteArray* idat = g_byte_array_new();
+    gboolean ihdr = FALSE, iend = FALSE;
+    gsize pos = sizeof(signature);
+    uLongf len = (uLongf)(n * image->height);
+    guint8* pixels = g_malloc(len + 1);
+    guint x, y;
+
+    g_assert_cmpuint(size, > ,sizeof(signature));
+    g_assert(!memcmp(png, signature, sizeof(signature)));
+    while (pos < size) {
+        const guint8* chunk = png + pos;
+        guint32 clen;
+
+        g_assert(!iend);
+        g_assert_cmpuint(size - pos, >= ,12);
+        clen = test_get32(chunk);
+        g_assert_cmpuint(size - pos - 12, >= ,clen);
+        g_assert_cmpuint(test_get32(chunk + 8 + clen), == ,
+            crc32(0, chunk + 4, clen + 4));
+        if (!memcmp(chunk + 4, "IHDR", 4)) {
+            g_assert(!ihdr);
+            g_assert_cmpuint(clen, == ,13);
+            g_assert_cmpuint(test_get32(chunk + 8), == ,image->width);
+            g_assert_cmpuint(test_get32(chunk + 12), == ,image->height);
+            g_assert_cmpuint(chunk[16], == ,1); /* Bit depth */
+            g_assert_cmpuint(chunk[17], == ,0); /* Grayscale */
+            g_assert_cmpuint(chunk[18], == ,0);
+            g_assert_cmpuint(chunk[19], == ,0);
+            g_assert_cmpuint(chunk[20], == ,0);
+            ihdr = TRUE;
+        } else if (!memcmp(chunk + 4, "IDAT", 4)) {
+            g_assert(ihdr);
+            g_byte_array_append(idat, chunk + 8, clen);
+        } else {
+            g_assert(!memcmp(chunk + 4, "IEND", 4));
+            g_assert_cmpuint(clen, == ,0);
+            iend = TRUE;
+        }
+        pos += 12 + clen;
+    }
+    g_assert(iend);
+
+    /* The zlib stream (including the checksum) has to be valid */
+    len++;
+    g_assert_cmpint(uncompress(pixels, &len, idat->data, idat->len), == ,
+        Z_OK);
+    g_assert_cmpuint(len, == ,n * image->height);
+
+    /* Filter type None, in PNG 0 is black */
+    for (y = 0; y < image->height; y++) {
+        const guint8* src = pixels + n * y;
+        const guint8* ref = image->bits->data + image->rowsize * y;
+
+        g_assert_cmpuint(src[0], == ,0);
+        for (x = 0; x < image->width; x++) {
+            const guint bit = 0x80 >> (x % 8);
+
+            g_assert_cmpuint(!(src[1 + x / 8] & bit), == ,
+                !!(ref[x / 8] & bit));
+        }
+    }
+
+    g_free(pixels);
+    g_byte_array_unref(idat);
+}
+
+/* Writes the reader's image with rows_png_save() and checks it */
+static
+void
+test_check_reader(
+    AztecRowReader* reader,
+    AztecRowReader* ref)
+{
+    char* buf = NULL;
+    size_t size = 0;
+    FILE* f = open_memstream(&buf, &size);
+    TestImage image;
+
+    g_assert(f);
+    g_assert(rows_png_save(reader, f));
+    g_assert(!fclose(f));
+    test_image_init(&image, ref);
+    test_check_png((const guint8*)buf, size, &image);
+    test_image_deinit(&image);
+    free(buf);
+}
+
+static
+void
+test_check_symbol(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border)
+{
+    AztecRowReader* reader = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, scale, border);
+    AztecRowReader* ref = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, scale, border);
+
+    test_check_reader(reader, ref);
+    aztec_row_reader_free(reader);
+    aztec_row_reader_free(ref);
+}
+
+/* symbols */
+
+static
+void
+test_symbols(
+    void)
+{
+    static const guint scale[] = { 1, 2, 3, 8, 21 };
+    const char* msgs[4];
+    char* big = g_strnfill(1000, 'z');
+    guint8 binary[300];
+    guint i, k, border;
+
+    /* Binary data makes a lot of literals */
+    for (i = 0; i < sizeof(binary); i++) {
+        binary[i] = (guint8)(i * 167 + (i >> 3) * 13);
+    }
+    msgs[0] = "A";
+    msgs[1] = test_msg;
+    msgs[2] = big;
+    msgs[3] = (const char*)binary;
+    for (k = 0; k < G_N_ELEMENTS(msgs); k++) {
+        const gsize len = (k == 3) ? sizeof(binary) : strlen(msgs[k]);
+        AztecSymbol* s1 = aztec_encode(msgs[k], len, 0);
+        AztecSymbol* s2 = aztec_encode_inv(msgs[k], len, 0);
+
+        for (i = 0; i < G_N_ELEMENTS(scale); i++) {
+            for (border = 0; border < 4; border++) {
+                test_check_symbol(s1, scale[i], border);
+                test_check_symbol(s2, scale[i], border);
+            }
+        }
+        aztec_symbol_free(s1);
+        aztec_symbol_free(s2);
+    }
+    g_free(big);
+}
+
+/* long_runs */
+
+static
+void
+test_long_runs(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode("A", 1, 0);
+
+    /*
+     * Each row is more than 258 bytes long and the image is much larger
+     * than the 32K window.
+     */
+    test_check_symbol(symbol, 200, 6);
+    test_check_symbol(symbol, 173, 1);
+    aztec_symbol_free(symbol);
+}
+
+/* sheet */
+
+static
+void
+test_sheet(
+    void)
+{
+    AztecSymbol* s1 = aztec_encode("A", 1, 0);
+    AztecSymbol* s2 = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    const AztecSymbol* symbols[] = { s1, s2, s2, NULL, s1, s2, s1 };
+    static const guint columns[] = { 1, 2, 4, 5 };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(columns); i++) {
+        AztecRowReader* reader = aztec_row_reader_new_sheet(symbols,
+            G_N_ELEMENTS(symbols), columns[i], AZTEC_PIXEL_MONO_MSB, 3, 1);
+        AztecRowReader* ref = aztec_row_reader_new_sheet(symbols,
+            G_N_ELEMENTS(symbols), columns[i], AZTEC_PIXEL_MONO_MSB, 3, 1);
+
+        test_check_reader(reader, ref);
+        aztec_row_reader_free(reader);
+        aztec_row_reader_free(ref);
+    }
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+}
+
+/* widest */
+
+static
+void
+test_widest(
+    void)
+{
+    AztecSymbol* s1 = aztec_encode("A", 1, 0);
+    AztecSymbol* s2 = aztec_encode_inv("B", 1, 0);
+    const AztecSymbol* symbols[] = { s1, s2 };
+    const guint max = ROWS_PNG_MAX_ROWSIZE * 8;
+    guint border;
+
+    /*
+     * One row of symbols exactly ROWS_PNG_MAX_ROWSIZE bytes wide, the
+     * rows being copied from the row above 32K back.
+     */
+    for (border = 0; border < 16; border++) {
+        const guint cell = s1->size + 2 * border;
+        const guint columns = max / cell;
+
+        if (columns * cell > max - 8) {
+            AztecRowReader* reader = aztec_row_reader_new_sheet(symbols,
+                G_N_ELEMENTS(symbols), columns, AZTEC_PIXEL_MONO_MSB, 1,
+                border);
+            AztecRowReader* ref = aztec_row_reader_new_sheet(symbols,
+                G_N_ELEMENTS(symbols), columns, AZTEC_PIXEL_MONO_MSB, 1,
+                border);
+
+            g_assert_cmpuint(aztec_row_reader_rowsize(reader), == ,
+                ROWS_PNG_MAX_ROWSIZE);
+            test_check_reader(reader, ref);
+            aztec_row_reader_free(reader);
+            aztec_row_reader_free(ref);
+            break;
+        }
+    }
+    g_assert_cmpuint(border, < ,16);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+}
+
+/* Common */
+
+#define TEST_(x) "/rows_png/" x
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("symbols"), test_symbols);
+    g_test_add_func(TEST_("long_runs"), test_long_runs);
+    g_test_add_func(TEST_("sheet"), test_sheet);
+    g_test_add_func(TEST_("widest"), test_widest);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
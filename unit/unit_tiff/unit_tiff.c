@@ -0,0 +1,711 @@
+/*
+ * Copyright (C) 2026 by Slava Monich <slava@monich.com>
+ *
+ * You may use this file under the terms of the BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation
+ * are those of the authors and should not be interpreted as representing
+ * any official policies, either expressed or implied.
+ */
+
+#include "aztec_tiff.h"
+#include "aztec_render.h"
+
+#include <string.h>
+
+static const char test_msg[] = "Code 2D! slava@monich.com 0123456789";
+
+#define DATA_DIR "data/"
+
+typedef struct test_image {
+    guint width;
+    guint height;
+    gsize rowsize;
+    GByteArray* bits;
+} TestImage;
+
+typedef struct test_code {
+    guint16 code;
+    guint8 len;
+} TestCode;
+
+typedef struct test_bit_reader {
+    const guint8* data;
+    gsize size;
+    gsize pos;
+} TestBitReader;
+
+typedef enum test_g4_mode {
+    TEST_G4_VL3,
+    TEST_G4_VL2,
+    TEST_G4_VL1,
+    TEST_G4_V0,
+    TEST_G4_VR1,
+    TEST_G4_VR2,
+    TEST_G4_VR3,
+    TEST_G4_PASS,
+    TEST_G4_HORIZONTAL,
+    TEST_G4_EOL
+} TEST_G4_MODE;
+
+/* Indexed by TEST_G4_MODE */
+static const TestCode test_g4_modes[] = {
+    { 0x02, 7 }, { 0x02, 6 }, { 0x2, 3 }, { 0x1, 1 }, { 0x3, 3 },
+    { 0x03, 6 }, { 0x03, 7 }, { 0x1, 4 }, { 0x1, 3 }, { 0x001, 12 }
+};
+
+/* Terminating, make-up and extended make-up codes */
+static const TestCode test_g4_white[] = {
+    { 0x035, 8 }, { 0x007, 6 }, { 0x007, 4 }, { 0x008, 4 }, { 0x00b, 4 },
+    { 0x00c, 4 }, { 0x00e, 4 }, { 0x00f, 4 }, { 0x013, 5 }, { 0x014, 5 },
+    { 0x007, 5 }, { 0x008, 5 }, { 0x008, 6 }, { 0x003, 6 }, { 0x034, 6 },
+    { 0x035, 6 }, { 0x02a, 6 }, { 0x02b, 6 }, { 0x027, 7 }, { 0x00c, 7 },
+    { 0x008, 7 }, { 0x017, 7 }, { 0x003, 7 }, { 0x004, 7 }, { 0x028, 7 },
+    { 0x02b, 7 }, { 0x013, 7 }, { 0x024, 7 }, { 0x018, 7 }, { 0x002, 8 },
+    { 0x003, 8 }, { 0x01a, 8 }, { 0x01b, 8 }, { 0x012, 8 }, { 0x013, 8 },
+    { 0x014, 8 }, { 0x015, 8 }, { 0x016, 8 }, { 0x017, 8 }, { 0x028, 8 },
+    { 0x029, 8 }, { 0x02a, 8 }, { 0x02b, 8 }, { 0x02c, 8 }, { 0x02d, 8 },
+    { 0x004, 8 }, { 0x005, 8 }, { 0x00a, 8 }, { 0x00b, 8 }, { 0x052, 8 },
+    { 0x053, 8 }, { 0x054, 8 }, { 0x055, 8 }, { 0x024, 8 }, { 0x025, 8 },
+    { 0x058, 8 }, { 0x059, 8 }, { 0x05a, 8 }, { 0x05b, 8 }, { 0x04a, 8 },
+    { 0x04b, 8 }, { 0x032, 8 }, { 0x033, 8 }, { 0x034, 8 }, { 0x01b, 5 },
+    { 0x012, 5 }, { 0x017, 6 }, { 0x037, 7 }, { 0x036, 8 }, { 0x037, 8 },
+    { 0x064, 8 }, { 0x065, 8 }, { 0x068, 8 }, { 0x067, 8 }, { 0x0cc, 9 },
+    { 0x0cd, 9 }, { 0x0d2, 9 }, { 0x0d3, 9 }, { 0x0d4, 9 }, { 0x0d5, 9 },
+    { 0x0d6, 9 }, { 0x0d7, 9 }, { 0x0d8, 9 }, { 0x0d9, 9 }, { 0x0da, 9 },
+    { 0x0db, 9 }, { 0x098, 9 }, { 0x099, 9 }, { 0x09a, 9 }, { 0x018, 6 },
+    { 0x09b, 9 }, { 0x008, 11 }, { 0x00c, 11 }, { 0x00d, 11 },
+    { 0x012, 12 }, { 0x013, 12 }, { 0x014, 12 }, { 0x015, 12 },
+    { 0x016, 12 }, { 0x017, 12 }, { 0x01c, 12 }, { 0x01d, 12 },
+    { 0x01e, 12 }, { 0x01f, 12 },
+};
+
+static const TestCode test_g4_black[] = {
+    { 0x037, 10 }, { 0x002, 3 }, { 0x003, 2 }, { 0x002, 2 }, { 0x003, 3 },
+    { 0x003, 4 }, { 0x002, 4 }, { 0x003, 5 }, { 0x005, 6 }, { 0x004, 6 },
+    { 0x004, 7 }, { 0x005, 7 }, { 0x007, 7 }, { 0x004, 8 }, { 0x007, 8 },
+    { 0x018, 9 }, { 0x017, 10 }, { 0x018, 10 }, { 0x008, 10 },
+    { 0x067, 11 }, { 0x068, 11 }, { 0x06c, 11 }, { 0x037, 11 },
+    { 0x028, 11 }, { 0x017, 11 }, { 0x018, 11 }, { 0x0ca, 12 },
+    { 0x0cb, 12 }, { 0x0cc, 12 }, { 0x0cd, 12 }, { 0x068, 12 },
+    { 0x069, 12 }, { 0x06a, 12 }, { 0x06b, 12 }, { 0x0d2, 12 },
+    { 0x0d3, 12 }, { 0x0d4, 12 }, { 0x0d5, 12 }, { 0x0d6, 12 },
+    { 0x0d7, 12 }, { 0x06c, 12 }, { 0x06d, 12 }, { 0x0da, 12 },
+    { 0x0db, 12 }, { 0x054, 12 }, { 0x055, 12 }, { 0x056, 12 },
+    { 0x057, 12 }, { 0x064, 12 }, { 0x065, 12 }, { 0x052, 12 },
+    { 0x053, 12 }, { 0x024, 12 }, { 0x037, 12 }, { 0x038, 12 },
+    { 0x027, 12 }, { 0x028, 12 }, { 0x058, 12 }, { 0x059, 12 },
+    { 0x02b, 12 }, { 0x02c, 12 }, { 0x05a, 12 }, { 0x066, 12 },
+    { 0x067, 12 }, { 0x00f, 10 }, { 0x0c8, 12 }, { 0x0c9, 12 },
+    { 0x05b, 12 }, { 0x033, 12 }, { 0x034, 12 }, { 0x035, 12 },
+    { 0x06c, 13 }, { 0x06d, 13 }, { 0x04a, 13 }, { 0x04b, 13 },
+    { 0x04c, 13 }, { 0x04d, 13 }, { 0x072, 13 }, { 0x073, 13 },
+    { 0x074, 13 }, { 0x075, 13 }, { 0x076, 13 }, { 0x077, 13 },
+    { 0x052, 13 }, { 0x053, 13 }, { 0x054, 13 }, { 0x055, 13 },
+    { 0x05a, 13 }, { 0x05b, 13 }, { 0x064, 13 }, { 0x065, 13 },
+    { 0x008, 11 }, { 0x00c, 11 }, { 0x00d, 11 }, { 0x012, 12 },
+    { 0x013, 12 }, { 0x014, 12 }, { 0x015, 12 }, { 0x016, 12 },
+    { 0x017, 12 }, { 0x01c, 12 }, { 0x01d, 12 }, { 0x01e, 12 },
+    { 0x01f, 12 },
+};
+
+static
+gboolean
+test_image_row(
+    const guint8* row,
+    gsize rowsize,
+    guint repeat,
+    gpointer user_data)
+{
+    TestImage* image = user_data;
+
+    while (repeat--) {
+        g_byte_array_append(image->bits, row, rowsize);
+    }
+    return TRUE;
+}
+
+static
+void
+test_image_init(
+    TestImage* image,
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border)
+{
+    image->width = image->height = (symbol->size + 2 * border) * scale;
+    image->rowsize = (image->width + 7) / 8;
+    image->bits = g_byte_array_new();
+    g_assert(aztec_symbol_render(symbol, AZTEC_PIXEL_MONO_MSB, scale, border,
+        test_image_row, image));
+    g_assert_cmpuint(image->bits->len, == ,image->rowsize * image->width);
+}
+
+static
+void
+test_image_init_reader(
+    TestImage* image,
+    AztecRowReader* reader)
+{
+    const guint8* row;
+    guint repeat;
+
+    image->width = aztec_row_reader_width(reader);
+    image->height = aztec_row_reader_height(reader);
+    image->rowsize = aztec_row_reader_rowsize(reader);
+    image->bits = g_byte_array_new();
+    while ((row = aztec_row_reader_next(reader, &repeat)) != NULL) {
+        test_image_row(row, image->rowsize, repeat, image);
+    }
+    g_assert_cmpuint(image->bits->len, == ,image->rowsize * image->height);
+}
+
+static
+void
+test_image_deinit(
+    TestImage* image)
+{
+    g_byte_array_unref(image->bits);
+}
+
+static
+guint
+test_image_pixel(
+    const TestImage* image,
+    guint x,
+    guint y)
+{
+    return (image->bits->data[y * image->rowsize + x / 8] >> (7 - x % 8)) & 1;
+}
+
+/* g4 decoder */
+
+static
+guint
+test_read_bit(
+    TestBitReader* in)
+{
+    const gsize pos = in->pos++;
+
+    g_assert_cmpuint(pos / 8, < ,in->size);
+    return (in->data[pos / 8] >> (7 - pos % 8)) & 1;
+}
+
+static
+TEST_G4_MODE
+test_read_mode(
+    TestBitReader* in)
+{
+    guint code = 0, len = 0;
+
+    while (len < 12) {
+        guint i;
+
+        code = (code << 1) | test_read_bit(in);
+        len++;
+        for (i = 0; i < G_N_ELEMENTS(test_g4_modes); i++) {
+            if (test_g4_modes[i].len == len && test_g4_modes[i].code == code) {
+                return (TEST_G4_MODE) i;
+            }
+        }
+    }
+    g_assert_not_reached();
+    return TEST_G4_EOL;
+}
+
+static
+guint
+test_read_span(
+    TestBitReader* in,
+    guint color)
+{
+    const TestCode* table = color ? test_g4_black : test_g4_white;
+    guint span = 0;
+
+    for (;;) {
+        guint code = 0, len = 0, i = G_N_ELEMENTS(test_g4_white);
+
+        while (i == G_N_ELEMENTS(test_g4_white)) {
+            g_assert_cmpuint(len, < ,13);
+            code = (code << 1) | test_read_bit(in);
+            len++;
+            for (i = 0; i < G_N_ELEMENTS(test_g4_white) &&
+                (table[i].len != len || table[i].code != code); i++);
+        }
+        if (i < 64) {
+            return span + i;
+        } else if (i < 91) {
+            span += (i - 63) * 64;
+        } else {
+            span += 1792 + (i - 91) * 64;
+        }
+    }
+}
+
+static
+void
+test_fill(
+    guint8* line,
+    gint from,
+    gint to,
+    guint color)
+{
+    g_assert_cmpint(from, <= ,to);
+    memset(line + from, color, to - from);
+}
+
+/* Returns TRUE if the line was coded with V0 only */
+static
+gboolean
+test_decode_line(
+    TestBitReader* in,
+    const guint8* ref,
+    guint8* line,
+    gint width)
+{
+    gboolean v0 = TRUE;
+    guint color = 0;
+    gint a0 = -1;
+
+    while (a0 < width) {
+        const TEST_G4_MODE mode = test_read_mode(in);
+        const gint start = MAX(a0, 0);
+        gint b1, b2;
+
+        /* First changing element right of a0 of the opposite color */
+        for (b1 = a0 + 1; b1 < width && (ref[b1] == color ||
+            (b1 > 0 && ref[b1 - 1] != color)); b1++);
+        for (b2 = b1 + 1; b2 < width && ref[b2] == ref[b1]; b2++);
+        b2 = MIN(b2, width);
+
+        if (mode != TEST_G4_V0) {
+            v0 = FALSE;
+        }
+        if (mode == TEST_G4_PASS) {
+            test_fill(line, start, b2, color);
+            a0 = b2;
+        } else if (mode == TEST_G4_HORIZONTAL) {
+            const guint r1 = test_read_span(in, color);
+            const guint r2 = test_read_span(in, !color);
+
+            g_assert_cmpint(start + r1 + r2, <= ,width);
+            test_fill(line, start, start + r1, color);
+            test_fill(line, start + r1, start + r1 + r2, !color);
+            a0 = start + r1 + r2;
+        } else {
+            const gint a1 = b1 + (gint) mode - TEST_G4_V0;
+
+            g_assert_cmpint(mode, <= ,TEST_G4_VR3);
+            g_assert_cmpint(a1, <= ,width);
+            test_fill(line, start, a1, color);
+            a0 = a1;
+            color = !color;
+        }
+    }
+    g_assert_cmpint(a0, == ,width);
+    return v0;
+}
+
+static
+void
+test_check_g4_data(
+    const guint8* data,
+    gsize size,
+    const TestImage* image)
+{
+    const guint w = image->width;
+    guint8* ref = g_malloc0(w);
+    guint8* line = g_malloc(w);
+    TestBitReader in;
+    guint x, y;
+
+    in.data = data;
+    in.size = size;
+    in.pos = 0;
+    for (y = 0; y < image->height; y++) {
+        const gboolean v0 = test_decode_line(&in, ref, line, w);
+        gboolean same = TRUE;
+
+        for (x = 0; x < w; x++) {
+            g_assert_cmpuint(line[x], == ,test_image_pixel(image, x, y));
+            if (y > 0 && test_image_pixel(image, x, y - 1) != line[x]) {
+                same = FALSE;
+            }
+        }
+
+        /* Replicated rows are coded with V0 only */
+        if (y > 0 && same) {
+            g_assert(v0);
+        }
+        memcpy(ref, line, w);
+    }
+
+    /* EOFB followed by zero padding */
+    g_assert_cmpint(test_read_mode(&in), == ,TEST_G4_EOL);
+    g_assert_cmpint(test_read_mode(&in), == ,TEST_G4_EOL);
+    while (in.pos % 8) {
+        g_assert_cmpuint(test_read_bit(&in), == ,0);
+    }
+    g_assert_cmpuint(in.pos / 8, == ,size);
+    g_free(ref);
+    g_free(line);
+}
+
+static
+void
+test_check_g4(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border)
+{
+    GBytes* g4 = aztec_symbol_g4(symbol, scale, border);
+    TestImage image;
+    gsize size;
+    const guint8* data = g_bytes_get_data(g4, &size);
+
+    test_image_init(&image, symbol, scale, border);
+    test_check_g4_data(data, size, &image);
+    test_image_deinit(&image);
+    g_bytes_unref(g4);
+}
+
+/* tiff */
+
+static
+guint
+test_get16(
+    const guint8* ptr)
+{
+    return ptr[0] | (ptr[1] << 8);
+}
+
+static
+guint
+test_get32(
+    const guint8* ptr)
+{
+    return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((guint)ptr[3] << 24);
+}
+
+/* Returns the value of a single-valued SHORT or LONG entry */
+static
+guint
+test_tiff_tag(
+    const guint8* tiff,
+    guint tag)
+{
+    const guint8* ifd = tiff + test_get32(tiff + 4);
+    const guint n = test_get16(ifd);
+    guint i;
+
+    for (i = 0; i < n; i++) {
+        const guint8* entry = ifd + 2 + 12 * i;
+
+        if (test_get16(entry) == tag) {
+            g_assert_cmpuint(test_get32(entry + 4), == ,1);
+            switch (test_get16(entry + 2)) {
+            case 3:
+                return test_get16(entry + 8);
+            case 4:
+            case 5:
+                return test_get32(entry + 8);
+            }
+            g_assert_not_reached();
+        }
+    }
+    g_assert_not_reached();
+    return 0;
+}
+
+static
+void
+test_check_tiff(
+    const AztecSymbol* symbol,
+    guint scale,
+    guint border,
+    guint dpi)
+{
+    GBytes* tiff = aztec_symbol_tiff(symbol, scale, border, dpi);
+    GBytes* g4 = aztec_symbol_g4(symbol, scale, border);
+    const guint width = (symbol->size + 2 * border) * scale;
+    gsize size, g4size;
+    const guint8* data = g_bytes_get_data(tiff, &size);
+    const guint8* g4data = g_bytes_get_data(g4, &g4size);
+    const guint8* res;
+    guint offset, count;
+
+    g_assert(!memcmp(data, "II*\0", 4));
+    g_assert_cmpuint(test_tiff_tag(data, 256), == ,width);
+    g_assert_cmpuint(test_tiff_tag(data, 257), == ,width);
+    g_assert_cmpuint(test_tiff_tag(data, 258), == ,1);
+    g_assert_cmpuint(test_tiff_tag(data, 259), == ,4);
+    g_assert_cmpuint(test_tiff_tag(data, 262), == ,0);
+    g_assert_cmpuint(test_tiff_tag(data, 277), == ,1);
+    g_assert_cmpuint(test_tiff_tag(data, 278), == ,width);
+    g_assert_cmpuint(test_tiff_tag(data, 296), == ,dpi ? 2 : 1);
+
+    res = data + test_tiff_tag(data, 282);
+    g_assert_cmpuint(test_get32(res), == ,dpi ? dpi : 1);
+    g_assert_cmpuint(test_get32(res + 4), == ,1);
+    res = data + test_tiff_tag(data, 283);
+    g_assert_cmpuint(test_get32(res), == ,dpi ? dpi : 1);
+    g_assert_cmpuint(test_get32(res + 4), == ,1);
+
+    /* The strip is exactly what aztec_symbol_g4() produces */
+    offset = test_tiff_tag(data, 273);
+    count = test_tiff_tag(data, 279);
+    g_assert_cmpuint(offset + count, == ,size);
+    g_assert_cmpuint(count, == ,g4size);
+    g_assert(!memcmp(data + offset, g4data, count));
+
+    g_bytes_unref(tiff);
+    g_bytes_unref(g4);
+}
+
+/* null */
+
+static
+void
+test_null(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+
+    g_assert(!aztec_symbol_g4(NULL, 1, 0));
+    g_assert(!aztec_symbol_g4(symbol, 0, 0));
+    g_assert(!aztec_symbol_tiff(NULL, 1, 0, 0));
+    g_assert(!aztec_symbol_tiff(symbol, 0, 0, 300));
+    aztec_symbol_free(symbol);
+}
+
+/* g4 */
+
+static
+void
+test_g4(
+    void)
+{
+    static const guint scale[] = { 1, 2, 3, 8, 21 };
+    static const char* msgs[] = { "A", test_msg, NULL };
+    char* big = g_strnfill(1000, 'z');
+    guint i, k, border;
+
+    msgs[2] = big;
+    for (k = 0; k < G_N_ELEMENTS(msgs); k++) {
+        AztecSymbol* s1 = aztec_encode(msgs[k], strlen(msgs[k]), 0);
+        AztecSymbol* s2 = aztec_encode_inv(msgs[k], strlen(msgs[k]), 0);
+
+        for (i = 0; i < G_N_ELEMENTS(scale); i++) {
+            for (border = 0; border < 3; border++) {
+                test_check_g4(s1, scale[i], border);
+                test_check_g4(s2, scale[i], border);
+            }
+        }
+        aztec_symbol_free(s1);
+        aztec_symbol_free(s2);
+    }
+    g_free(big);
+}
+
+static
+void
+test_g4_long_runs(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode("A", 1, 0);
+
+    /* Runs longer than 2560 pixels need several make-up codes */
+    test_check_g4(symbol, 200, 6);
+    test_check_g4(symbol, 173, 1);
+    aztec_symbol_free(symbol);
+}
+
+/* tiff */
+
+static
+void
+test_tiff(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+
+    test_check_tiff(symbol, 1, 0, 0);
+    test_check_tiff(symbol, 3, 1, 300);
+    test_check_tiff(symbol, 10, 4, 600);
+    aztec_symbol_free(symbol);
+}
+
+/* tiff_partial */
+
+static
+void
+test_tiff_partial(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    AztecRowReader* r1 = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, 3, 1);
+    AztecRowReader* r2 = aztec_row_reader_new(symbol,
+        AZTEC_PIXEL_MONO_MSB, 3, 1);
+    const guint width = aztec_row_reader_width(r1);
+    guint skipped = 0, repeat;
+    GBytes* tiff;
+    GBytes* g4;
+    const guint8* data;
+    const guint8* g4data;
+    gsize size;
+
+    /* Consume the same rows from both readers */
+    while (skipped < width / 2) {
+        g_assert(aztec_row_reader_next(r1, &repeat));
+        skipped += repeat;
+        g_assert(aztec_row_reader_next(r2, &repeat));
+    }
+    tiff = aztec_row_reader_tiff(r1, 0);
+    g4 = aztec_row_reader_g4(r2);
+    data = g_bytes_get_data(tiff, NULL);
+    g4data = g_bytes_get_data(g4, &size);
+
+    /* Only the remaining rows are described */
+    g_assert_cmpuint(test_tiff_tag(data, 256), == ,width);
+    g_assert_cmpuint(test_tiff_tag(data, 257), == ,width - skipped);
+    g_assert_cmpuint(test_tiff_tag(data, 278), == ,width - skipped);
+    g_assert_cmpuint(test_tiff_tag(data, 279), == ,size);
+    g_assert(!memcmp(data + test_tiff_tag(data, 273), g4data, size));
+
+    aztec_row_reader_free(r1);
+    aztec_row_reader_free(r2);
+    g_bytes_unref(tiff);
+    g_bytes_unref(g4);
+    aztec_symbol_free(symbol);
+}
+
+/* sheet */
+
+static
+void
+test_sheet(
+    void)
+{
+    AztecSymbol* s1 = aztec_encode("A", 1, 0);
+    AztecSymbol* s2 = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    const AztecSymbol* symbols[] = { s1, s2, s2, NULL, s1, s2, s1 };
+    static const guint columns[] = { 1, 2, 4, 5 };
+    AztecRowReader* lsb;
+    guint i;
+
+    /* None of these is square */
+    for (i = 0; i < G_N_ELEMENTS(columns); i++) {
+        AztecRowReader* r1 = aztec_row_reader_new_sheet(symbols,
+            G_N_ELEMENTS(symbols), columns[i], AZTEC_PIXEL_MONO_MSB, 3, 1);
+        AztecRowReader* r2 = aztec_row_reader_new_sheet(symbols,
+            G_N_ELEMENTS(symbols), columns[i], AZTEC_PIXEL_MONO_MSB, 3, 1);
+        AztecRowReader* r3 = aztec_row_reader_new_sheet(symbols,
+            G_N_ELEMENTS(symbols), columns[i], AZTEC_PIXEL_MONO_MSB, 3, 1);
+        GBytes* g4 = aztec_row_reader_g4(r1);
+        GBytes* tiff = aztec_row_reader_tiff(r3, 0);
+        const guint8* data = g_bytes_get_data(tiff, NULL);
+        gsize size;
+        const guint8* g4data = g_bytes_get_data(g4, &size);
+        TestImage image;
+
+        test_image_init_reader(&image, r2);
+        g_assert_cmpuint(image.width, != ,image.height);
+        test_check_g4_data(g4data, size, &image);
+        g_assert_cmpuint(test_tiff_tag(data, 256), == ,image.width);
+        g_assert_cmpuint(test_tiff_tag(data, 257), == ,image.height);
+        g_assert_cmpuint(test_tiff_tag(data, 278), == ,image.height);
+        g_assert_cmpuint(test_tiff_tag(data, 279), == ,size);
+        g_assert(!memcmp(data + test_tiff_tag(data, 273), g4data, size));
+
+        test_image_deinit(&image);
+        aztec_row_reader_free(r1);
+        aztec_row_reader_free(r2);
+        aztec_row_reader_free(r3);
+        g_bytes_unref(g4);
+        g_bytes_unref(tiff);
+    }
+
+    /* Only MONO_MSB is supported */
+    g_assert(!aztec_row_reader_g4(NULL));
+    g_assert(!aztec_row_reader_tiff(NULL, 0));
+    lsb = aztec_row_reader_new_sheet(symbols, 2, 2, AZTEC_PIXEL_MONO_LSB,
+        1, 0);
+    g_assert(!aztec_row_reader_g4(lsb));
+    g_assert(!aztec_row_reader_tiff(lsb, 0));
+    aztec_row_reader_free(lsb);
+    aztec_symbol_free(s1);
+    aztec_symbol_free(s2);
+}
+
+/* golden */
+
+static
+void
+test_golden(
+    void)
+{
+    AztecSymbol* symbol = aztec_encode(test_msg, sizeof(test_msg) - 1, 0);
+    GBytes* tiff = aztec_symbol_tiff(symbol, 4, 1, 300);
+    gchar* golden = NULL;
+    gsize len = 0;
+
+    g_assert(g_file_get_contents(DATA_DIR "g4_s4_b1_300.tif", &golden,
+        &len, NULL));
+    g_assert_cmpuint(g_bytes_get_size(tiff), == ,len);
+    g_assert(!memcmp(g_bytes_get_data(tiff, NULL), golden, len));
+    g_bytes_unref(tiff);
+    g_free(golden);
+    aztec_symbol_free(symbol);
+}
+
+/* Common */
+
+#define TEST_(x) "/tiff/" x
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("null"), test_null);
+    g_test_add_func(TEST_("g4"), test_g4);
+    g_test_add_func(TEST_("g4_long_runs"), test_g4_long_runs);
+    g_test_add_func(TEST_("tiff"), test_tiff);
+    g_test_add_func(TEST_("tiff_partial"), test_tiff_partial);
+    g_test_add_func(TEST_("sheet"), test_sheet);
+    g_test_add_func(TEST_("golden"), test_golden);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */